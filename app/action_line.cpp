@@ -0,0 +1,102 @@
+#include "action_line.hpp"
+#include "log.hpp"
+
+#include <ostream>
+#include <mutex>
+
+#include <prc/detail/profile.hpp>
+#include <prc/parser/as_type.hpp>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/fusion/adapted/std_pair.hpp>
+
+namespace x3 = boost::spirit::x3;
+
+namespace prc::actions
+{
+namespace
+{
+x3::rule<struct range_name_class,
+         std::vector<std::pair<std::string, std::string>>> const _range_name =
+    "range name";
+
+auto const _position = parser::as<
+    std::string>[x3::lexeme[+(x3::upper | x3::digit | x3::char_('+'))]];
+
+auto const _action = x3::lexeme[+(x3::char_ - '_')];
+auto const _range_name_def =
+    parser::as<std::pair<std::string, std::string>>[_position >> '_' >>
+                                                    _action] %
+    '_';
+
+BOOST_SPIRIT_DEFINE(_range_name);
+
+detail::profile_timer parse_timer{"parse_action_line"};
+
+template <typename Suffix>
+double parse_amount(std::string const& text, Suffix suffix)
+{
+  double ret = 0;
+  x3::phrase_parse(
+      text.begin(), text.end(), x3::double_ >> suffix, x3::space, ret);
+  return ret;
+}
+}
+
+action make_action(std::string position, std::string text)
+{
+  action ret{std::move(position), std::move(text), action_type::other, 0};
+  if (ret.text == "Fold")
+    ret.type = action_type::fold;
+  else if (ret.text == "Call")
+    ret.type = action_type::call;
+  else if (boost::algorithm::ends_with(ret.text, "bb"))
+  {
+    ret.type = action_type::bb;
+    ret.amount = parse_amount(ret.text, x3::lit("bb"));
+  }
+  else if (boost::algorithm::ends_with(ret.text, "%"))
+  {
+    ret.type = action_type::percent;
+    ret.amount = parse_amount(ret.text, x3::lit("%"));
+  }
+  return ret;
+}
+
+std::optional<action_line> parse_action_line(std::string const& range_name)
+{
+  detail::scoped_timer const timer{parse_timer};
+  std::vector<std::pair<std::string, std::string>> parts;
+  auto b = range_name.begin();
+  auto r = x3::phrase_parse(
+      b, range_name.end(), _range_name >> x3::eoi, x3::space, parts);
+  if (!r || b != range_name.end())
+    return std::nullopt;
+  action_line ret;
+  ret.reserve(parts.size());
+  for (auto& [pos, text] : parts)
+    ret.push_back(make_action(std::move(pos), std::move(text)));
+  return ret;
+}
+
+action_line const* action_line_cache::find(std::string const& range_name)
+{
+  {
+    std::shared_lock lock{_mutex};
+    if (auto it = _lines.find(range_name); it != _lines.end())
+      return it->second ? &*it->second : nullptr;
+  }
+  auto line = parse_action_line(range_name);
+  std::unique_lock lock{_mutex};
+  auto const [it, inserted] = _lines.emplace(range_name, std::move(line));
+  if (auto os = log(log_level::warning); inserted && !it->second && os)
+    *os << "Could not parse range name: " << range_name << ", skipping\n";
+  return it->second ? &*it->second : nullptr;
+}
+
+action_line const* find_action_line(std::string const& range_name)
+{
+  static action_line_cache cache;
+  return cache.find(range_name);
+}
+}
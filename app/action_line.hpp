@@ -0,0 +1,51 @@
+#pragma once
+
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace prc::actions
+{
+enum class action_type
+{
+  fold,
+  call,
+  bb,
+  percent,
+  other,
+};
+
+struct action
+{
+  std::string position;
+  // as written in the range name, e.g. "Call", "2.5bb" or "33%"
+  std::string text;
+  action_type type;
+  // size in bb or in percents of the pot, 0 for other types
+  double amount;
+};
+
+// range names are sequences of position_action, e.g. "UTG_2.5bb_BB_Call"
+using action_line = std::vector<action>;
+
+action make_action(std::string position, std::string text);
+std::optional<action_line> parse_action_line(std::string const& range_name);
+
+// Parses each range name once, can be used from multiple threads. Returned
+// pointers stay valid as long as the cache.
+class action_line_cache
+{
+public:
+  // nullptr when the name is not an action line, which is logged once
+  action_line const* find(std::string const& range_name);
+
+private:
+  std::shared_mutex _mutex;
+  std::unordered_map<std::string, std::optional<action_line>> _lines;
+};
+
+// shared by every action of the app
+action_line const* find_action_line(std::string const& range_name);
+}
@@ -0,0 +1,134 @@
+#include "action_tree.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+#include <prc/detail/format.hpp>
+
+namespace prc::actions
+{
+namespace
+{
+constexpr detail::float_format bb_amount_format{std::chars_format::fixed, 2, 1};
+
+bet_state initial_state()
+{
+  return {2.5, 1.0, {{"SB", 0.5}, {"BB", 1.0}}};
+}
+
+double& committed_by(bet_state& s, std::string const& position)
+{
+  auto it = std::find_if(
+      s.committed.begin(), s.committed.end(), [&](auto const& p) {
+        return p.first == position;
+      });
+  if (it != s.committed.end())
+    return it->second;
+  return s.committed.emplace_back(position, 0.0).second;
+}
+
+action_tree::node* find_child(action_tree::node const& n, action const& a)
+{
+  auto it = std::find_if(
+      n.children.begin(), n.children.end(), [&](auto const& c) {
+        return c->act.position == a.position && c->act.text == a.text;
+      });
+  return it != n.children.end() ? it->get() : nullptr;
+}
+
+std::unique_ptr<action_tree::node> make_child(action_tree::node const& parent,
+                                              action const& a)
+{
+  auto ret = std::make_unique<action_tree::node>(
+      action_tree::node{a, parent.state, parent.name, {}});
+  auto& state = ret->state;
+  auto& name = ret->name;
+  if (!name.empty())
+    name += '_';
+  name += a.position;
+  name += '_';
+  // folds and the final position_strategy put nothing in the pot
+  if (a.type == action_type::fold || a.text == "strategy")
+  {
+    name += a.text;
+    return ret;
+  }
+  if (a.type == action_type::percent)
+  {
+    // when RFI percent is 28%, it gives 1.98, the actual percent is
+    // around 28.6, which is not in the range name
+    state.last_bet = std::max(state.bet_size(a.position, a.amount),
+                              2 * state.last_bet);
+    append_bb_amount(name, state.last_bet);
+  }
+  else
+  {
+    if (a.type == action_type::bb)
+      state.last_bet = a.amount;
+    name += a.text;
+  }
+  auto& committed = committed_by(state, a.position);
+  state.pot += state.last_bet - committed;
+  committed = state.last_bet;
+  return ret;
+}
+}
+
+double bet_state::committed_by(std::string const& position) const
+{
+  for (auto const& [pos, amount] : committed)
+  {
+    if (pos == position)
+      return amount;
+  }
+  return 0.0;
+}
+
+double bet_state::bet_size(std::string const& position, double percent) const
+{
+  auto const amount_to_call = last_bet - committed_by(position);
+  return last_bet + (pot + amount_to_call) * (percent / 100.f);
+}
+
+action_tree::action_tree() : _root{{}, initial_state(), {}, {}}
+{
+}
+
+action_tree::node const& action_tree::find(action_line const& line)
+{
+  {
+    std::shared_lock lock{_mutex};
+    auto current = &_root;
+    for (auto const& a : line)
+    {
+      current = find_child(*current, a);
+      if (!current)
+        break;
+    }
+    if (current)
+      return *current;
+  }
+  std::unique_lock lock{_mutex};
+  auto current = &_root;
+  for (auto const& a : line)
+  {
+    auto child = find_child(*current, a);
+    if (!child)
+      child = current->children.emplace_back(make_child(*current, a)).get();
+    current = child;
+  }
+  return *current;
+}
+
+action_tree::node const& find_action_node(action_line const& line)
+{
+  static action_tree tree;
+  return tree.find(line);
+}
+
+void append_bb_amount(std::string& out, double amount)
+{
+  detail::append_double(out, amount, bb_amount_format);
+  out += "bb";
+}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "action_line.hpp"
+
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace prc::actions
+{
+// Chips put in the pot along an action line, in bb.
+struct bet_state
+{
+  double pot;
+  double last_bet;
+  // what each position has put in the pot so far, blinds included
+  std::vector<std::pair<std::string, double>> committed;
+
+  double committed_by(std::string const& position) const;
+  // total bet when position bets percent of the pot, calling included
+  double bet_size(std::string const& position, double percent) const;
+};
+
+// Bet state after each prefix of the action lines seen so far. Sibling spots
+// share their prefixes, so each prefix is only simulated once. Can be used
+// from multiple threads, returned nodes stay valid as long as the tree.
+class action_tree
+{
+public:
+  struct node
+  {
+    action act;
+    bet_state state;
+    // the action line so far, with percents converted to bb
+    std::string name;
+    std::vector<std::unique_ptr<node>> children;
+  };
+
+  action_tree();
+
+  node const& find(action_line const& line);
+
+private:
+  node _root;
+  std::shared_mutex _mutex;
+};
+
+// shared by every action of the app
+action_tree::node const& find_action_node(action_line const& line);
+
+// 2.50 -> "2.5bb", 3.00 -> "3.0bb"
+void append_bb_amount(std::string& out, double amount);
+}
@@ -1,45 +1,32 @@
 #include "actions.hpp"
+#include "action_line.hpp"
+#include "action_tree.hpp"
+#include "log.hpp"
 
 #include <algorithm>
-#include <iomanip>
-#include <iostream>
+#include <ostream>
 #include <map>
 #include <vector>
 
-#include <prc/parser/as_type.hpp>
 #include <prc/range.hpp>
+#include <prc/range_index.hpp>
 
 #include <boost/algorithm/string.hpp>
-#include <boost/fusion/adapted/std_pair.hpp>
 
 namespace fs = std::filesystem;
-namespace x3 = boost::spirit::x3;
 
 namespace prc::actions
 {
 namespace
 {
-x3::rule<struct range_name_class,
-         std::vector<std::pair<std::string, std::string>>> const _range_name =
-    "range name";
-
-auto const _position = parser::as<
-    std::string>[x3::lexeme[+(x3::upper | x3::digit | x3::char_('+'))]];
-
-auto const _action = x3::lexeme[+(x3::char_ - '_')];
-auto const _range_name_def =
-    parser::as<std::pair<std::string, std::string>>[_position >> '_' >>
-                                                    _action] %
-    '_';
-
-BOOST_SPIRIT_DEFINE(_range_name);
-
-struct flattened_range
-{
-  fs::path fullpath;
-  prc::folder* parent_folder;
-  prc::range* range;
-};
+log_counter renamed_ranges{"renamed ranges"};
+log_counter recolored_ranges{"recolored ranges"};
+log_counter unassigned_subranges{"added unassigned subranges"};
+log_counter converted_ranges{"ranges converted to bb"};
+log_counter removed_ranges{"removed ranges"};
+log_counter replaced_parent_ranges{"replaced parent ranges"};
+log_counter nested_ranges{"nested ranges"};
+log_counter removed_folders{"removed empty folders"};
 
 struct parent_child_range
 {
@@ -48,7 +35,7 @@ struct parent_child_range
   fs::path parent_path;
   fs::path child_path;
   prc::folder* child_parent_folder;
-  std::string subrange_name;
+  interned_name subrange_name;
 };
 
 struct parent_range_info
@@ -68,22 +55,6 @@ bool has_vsxbet_folders(folder& root)
   return it != root.entries().end();
 }
 
-void recurse_fill_ranges(folder& root,
-                         fs::path const& current_path,
-                         std::vector<flattened_range>& out)
-{
-  for (auto& entry : root.entries())
-  {
-    if (auto p = boost::variant2::get_if<range>(&entry))
-      out.push_back({current_path / p->name(), &root, p});
-    else
-    {
-      auto& subfolder = boost::variant2::get<folder>(entry);
-      recurse_fill_ranges(subfolder, current_path / subfolder.name(), out);
-    }
-  }
-}
-
 int recurse_count_subranges(range const& r)
 {
   auto count = 1;
@@ -92,46 +63,31 @@ int recurse_count_subranges(range const& r)
   return count;
 }
 
-std::vector<std::pair<std::string, std::string>> parse_range_name(
-    std::string const& input)
-{
-  std::vector<std::pair<std::string, std::string>> ret;
-  auto b = input.begin();
-  auto r =
-      x3::phrase_parse(b, input.end(), _range_name >> x3::eoi, x3::space, ret);
-  if (!r || b != input.end())
-  {
-    std::cout << "Could not parse range name: " << input << ", skipping"
-              << std::endl;
-    return {};
-  }
-  return ret;
-}
-
 void replace_parent_range(parent_child_range& p)
 {
-  auto const& subranges = p.parent->subranges();
-  auto const subrange_it =
-      std::find_if(subranges.begin(), subranges.end(), [&](auto& s) {
-        return s.name() == p.subrange_name;
-      });
-  if (subrange_it == subranges.end())
+  auto const subrange = p.parent->find_subrange(p.subrange_name);
+  if (!subrange)
   {
     // TODO add fmt once conan-center-index boost 1.75.0 is fixed
-    std::cout << p.parent_path << ": no subrange " << p.subrange_name
-              << std::endl;
-
-    std::cout << p.child_path << ": could not replace parent range"
-              << std::endl;
+    if (auto os = log(log_level::warning))
+    {
+      *os << p.parent_path << ": no subrange " << p.subrange_name.str()
+          << '\n'
+          << p.child_path << ": could not replace parent range\n";
+    }
     return;
   }
-  auto const& parent_range_elems = subrange_it->elems();
+  auto const& parent_range_elems = subrange->elems();
   auto const adjusted_parent_elems =
       adjust_weights(parent_range_elems, *p.parent);
   auto adjusted_elems = adjust_weights(adjusted_parent_elems, *p.child);
   p.child->set_elems(std::move(adjusted_elems));
-  std::cout << p.child_path << ": replaced parent range by subrange "
-            << p.subrange_name << " of " << p.parent_path << std::endl;
+  replaced_parent_ranges.increment();
+  if (auto os = log(log_level::debug))
+  {
+    *os << p.child_path << ": replaced parent range by subrange "
+        << p.subrange_name.str() << " of " << p.parent_path << '\n';
+  }
 }
 
 void nest_range(parent_child_range& p)
@@ -140,61 +96,64 @@ void nest_range(parent_child_range& p)
   if (!subrange)
   {
     // TODO add fmt once conan-center-index boost 1.75.0 is fixed
-    std::cout << p.parent_path << ": no subrange " << p.subrange_name
-              << std::endl;
-
-    std::cout << p.child_path << ": could not nest" << std::endl;
+    if (auto os = log(log_level::warning))
+    {
+      *os << p.parent_path << ": no subrange " << p.subrange_name.str()
+          << '\n'
+          << p.child_path << ": could not nest\n";
+    }
     return;
   }
 
   auto const prefix = boost::algorithm::erase_all_copy(
       p.parent_path.filename().string(), "_strategy");
   auto const new_name = boost::algorithm::erase_all_copy(
-      p.child_path.filename().string(), prefix + '_' + p.subrange_name + '_');
+      p.child_path.filename().string(),
+      prefix + '_' + p.subrange_name.str() + '_');
   // nesting is a bit weird in equilab, ranges have 100% of their parent
-  std::vector<prc::combo> combos;
+  prc::combo_set combos;
   for (auto const& [w, e] : p.child->elems())
-  {
-    auto c = prc::expand_combos(e);
-    combos.insert(combos.end(), c.begin(), c.end());
-  }
-  auto new_range = *p.child;
+    combos.insert(e);
+  // the child is removed once everything is nested, only its name is still
+  // needed, and children are always nested before their parents
+  auto new_range = std::move(*p.child);
+  p.child->set_name(new_range.name());
   new_range.set_name(new_name);
   new_range.set_elems({{100.0, prc::reduce_combos(combos)}});
   // mimick equilab selection color
   new_range.set_rgb(0xff6ebaff);
   subrange->add_subrange(std::move(new_range));
-  std::cout << p.child_path << ": nested into subrange " << p.subrange_name
-            << " of " << p.parent_path << " as " << new_name << std::endl;
+  nested_ranges.increment();
+  if (auto os = log(log_level::debug))
+  {
+    *os << p.child_path << ": nested into subrange "
+        << p.subrange_name.str() << " of " << p.parent_path << " as "
+        << new_name << '\n';
+  }
 }
 
 std::optional<parent_range_info> get_parent_range_info(std::string const& name)
 {
-  auto const parts = parse_range_name(name);
-  if (parts.empty())
+  auto const line = find_action_line(name);
+  if (!line || line->empty())
     return std::nullopt;
-  auto const& position = parts.back().first;
+  auto const& position = line->back().position;
   auto const pos_it =
-      std::find_if(parts.rbegin() + 1, parts.rend(), [&position](auto& p) {
-        return p.first == position;
+      std::find_if(line->rbegin() + 1, line->rend(), [&position](auto& a) {
+        return a.position == position;
       });
-  if (pos_it == parts.rend())
+  if (pos_it == line->rend())
     return std::nullopt;
   std::string parent_name;
-  for (auto it = parts.begin(); it != pos_it.base() - 1; ++it)
-  {
-    auto const& [pos, action] = *it;
-    parent_name += pos + '_' + action + '_';
-  }
+  for (auto it = line->begin(); it != pos_it.base() - 1; ++it)
+    parent_name += it->position + '_' + it->text + '_';
   parent_name += position + "_strategy";
-  return {{std::move(parent_name), pos_it->second}};
+  return {{std::move(parent_name), pos_it->text}};
 }
 
-std::vector<flattened_range> flatten_ranges(folder& f,
-                                            fs::path const& current_path)
+range_index index_ranges(folder& f, fs::path const& current_path)
 {
-  std::vector<flattened_range> flattened_ranges;
-  recurse_fill_ranges(f, current_path, flattened_ranges);
+  auto flattened_ranges = flatten_ranges(f, current_path);
 
   std::sort(
       flattened_ranges.begin(),
@@ -209,35 +168,31 @@ std::vector<flattened_range> flatten_ranges(folder& f,
         return lhs.fullpath.parent_path().string() <
                rhs.fullpath.parent_path().string();
       });
-  return flattened_ranges;
+  return range_index{std::move(flattened_ranges)};
 }
 
-std::vector<parent_child_range> find_parent_ranges(
-    std::vector<flattened_range> const& flattened_ranges)
+// a range's parent is the closest range before it with the parent name
+std::vector<parent_child_range> find_parent_ranges(range_index const& index)
 {
   std::vector<parent_child_range> parent_ranges;
+  auto const& ranges = index.ranges();
 
-  for (auto it = flattened_ranges.rbegin(); it != flattened_ranges.rend(); ++it)
+  for (std::size_t i = 0; i < ranges.size(); ++i)
   {
-    auto info = get_parent_range_info(it->range->name());
-    if (info)
+    auto info = get_parent_range_info(ranges[i].range->name());
+    if (!info)
+      continue;
+    if (auto const parent_pos = index.find_before(info->name, i))
     {
-      auto const parent_it =
-          std::find_if(it + 1, flattened_ranges.rend(), [&info](auto& r) {
-            return r.range->name() == info->name;
-          });
-      if (parent_it != flattened_ranges.rend())
-      {
-        parent_ranges.push_back({parent_it->range,
-                                 it->range,
-                                 parent_it->fullpath,
-                                 it->fullpath,
-                                 it->parent_folder,
-                                 std::move(info->subrange_name)});
-      }
+      auto const& parent = ranges[*parent_pos];
+      parent_ranges.push_back({parent.range,
+                               ranges[i].range,
+                               parent.fullpath,
+                               ranges[i].fullpath,
+                               ranges[i].parent_folder,
+                               interned_name{info->subrange_name}});
     }
   }
-  std::reverse(parent_ranges.begin(), parent_ranges.end());
   return parent_ranges;
 }
 
@@ -289,25 +244,28 @@ inline namespace folder_actions
 {
 namespace
 {
+interned_name const fold_name{"Fold"};
+
 auto const has_only_fold = [](auto& r) {
-  return r.subranges().size() == 1 && r.subranges().front().name() == "Fold";
+  return r.subranges().size() == 1 &&
+         r.subranges().front().name_handle() == fold_name;
 };
 
 auto const has_no_subranges = [](auto& r) { return r.subranges().empty(); };
 
 auto const has_too_many_players = [](auto& r) {
-  auto const parts = parse_range_name(r.name());
-  if (parts.size() < 3)
+  auto const line = find_action_line(r.name());
+  if (!line || line->size() < 3)
     return false;
   // only keep squeeze spots when 3 players
   std::vector<std::string> positions;
   std::vector<std::string> actions;
-  auto const& current_pos = parts.back().first;
+  auto const& current_pos = line->back().position;
 
-  for (auto const& [pos, action] : parts)
+  for (auto const& a : *line)
   {
-    positions.push_back(pos);
-    actions.push_back(action);
+    positions.push_back(a.position);
+    actions.push_back(a.text);
   }
   {
     auto sorted_pos = positions;
@@ -340,286 +298,257 @@ auto const has_too_many_players = [](auto& r) {
 };
 }
 
-folder_action remove_useless_ranges()
-{
-  return [](folder& f, fs::path const& current_path) {
-    auto& entries = f.entries();
-    entries.erase(
-        std::remove_if(entries.begin(),
-                       entries.end(),
-                       [&](auto& e) {
-                         if (auto p = boost::variant2::get_if<range>(&e))
+bool remove_useless_ranges::operator()(folder& f,
+                                       lazy_path const& current_path) const
+{
+  auto& entries = f.entries();
+  entries.erase(
+      std::remove_if(entries.begin(),
+                     entries.end(),
+                     [&](auto& e) {
+                       if (auto p = boost::variant2::get_if<range>(&e))
+                       {
+                         auto b = has_only_fold(*p) || has_no_subranges(*p) ||
+                                  has_too_many_players(*p);
+                         if (!b)
+                           return false;
+                         removed_ranges.increment();
+                         if (auto os = log(log_level::debug))
                          {
-                           auto b = has_only_fold(*p) || has_no_subranges(*p) ||
-                                    has_too_many_players(*p);
-                           if (b)
-                           {
-                             std::cout << "Removing "
-                                       << current_path / p->name() << std::endl;
-                           }
-                           return b;
+                           *os << "Removing " << current_path / p->name()
+                               << '\n';
                          }
-                         return false;
-                       }),
-        entries.end());
-    return true;
-  };
+                         return true;
+                       }
+                       return false;
+                     }),
+      entries.end());
+  return true;
 }
 
-folder_action fix_parent_ranges()
+bool fix_parent_ranges::operator()(folder& f,
+                                   lazy_path const& current_path) const
 {
-  return [](auto& folder, fs::path const& current_path) {
-    // SB is the only position where limp raise happens
-    if (!has_vsxbet_folders(folder) && folder.name() != "SB")
-      return true;
-    auto const flattened_ranges = flatten_ranges(folder, current_path);
-    auto parent_ranges = find_parent_ranges(flattened_ranges);
+  // SB is the only position where limp raise happens
+  if (!has_vsxbet_folders(f) && f.name() != "SB")
+    return true;
+  auto const index = index_ranges(f, current_path.path());
+  auto parent_ranges = find_parent_ranges(index);
 
-    for (auto& elem : parent_ranges)
-      replace_parent_range(elem);
-    return false;
-  };
+  for (auto& elem : parent_ranges)
+    replace_parent_range(elem);
+  return false;
 }
 
-folder_action nest_parent_ranges()
+bool nest_parent_ranges::operator()(folder& f,
+                                    lazy_path const& current_path) const
 {
-  return [](auto& folder, fs::path const& current_path) {
-    if (!has_vsxbet_folders(folder))
-      return true;
-    auto const flattened_ranges = flatten_ranges(folder, current_path);
-    auto parent_ranges = find_parent_ranges(flattened_ranges);
-
-    for (auto it = parent_ranges.rbegin(); it != parent_ranges.rend(); ++it)
-      nest_range(*it);
-    // we can remove now, iterators can be invalidated
-    for (auto it = parent_ranges.rbegin(); it != parent_ranges.rend(); ++it)
-    {
-      it->child_parent_folder->remove_entry(it->child_path.filename().string());
-      std::cout << "removed " << it->child_path << std::endl;
-    }
+  if (!has_vsxbet_folders(f))
     return true;
-  };
+  auto const index = index_ranges(f, current_path.path());
+  auto parent_ranges = find_parent_ranges(index);
+
+  for (auto it = parent_ranges.rbegin(); it != parent_ranges.rend(); ++it)
+    nest_range(*it);
+  // we can remove now, iterators can be invalidated
+  for (auto it = parent_ranges.rbegin(); it != parent_ranges.rend(); ++it)
+  {
+    it->child_parent_folder->remove_entry(it->child_path.filename().string());
+    if (auto os = log(log_level::debug))
+      *os << "removed " << it->child_path << '\n';
+  }
+  return true;
 }
 
-folder_action remove_empty_folders()
-{
-  return [](auto& f, fs::path const& current_path) {
-    auto& entries = f.entries();
-    entries.erase(
-        std::remove_if(entries.begin(),
-                       entries.end(),
-                       [&](auto& e) {
-                         if (auto p = boost::variant2::get_if<folder>(&e))
+bool remove_empty_folders::operator()(folder& f,
+                                      lazy_path const& current_path) const
+{
+  auto& entries = f.entries();
+  entries.erase(
+      std::remove_if(entries.begin(),
+                     entries.end(),
+                     [&](auto& e) {
+                       if (auto p = boost::variant2::get_if<folder>(&e))
+                       {
+                         if (p->entries().empty())
                          {
-                           if (p->entries().empty())
+                           removed_folders.increment();
+                           if (auto os = log(log_level::debug))
                            {
-                             std::cout << "removing empty folder: "
-                                       << current_path / p->name() << std::endl;
-                             return true;
+                             *os << "removing empty folder: "
+                                 << current_path / p->name() << '\n';
                            }
+                           return true;
                          }
-                         return false;
-                       }),
-        entries.end());
-    return true;
-  };
+                       }
+                       return false;
+                     }),
+      entries.end());
+  return true;
 }
 }
 
 inline namespace range_actions
 {
-range_action replace_in_range_name(std::string const& old_str,
-                                   std::string const& new_str)
+replace_in_range_name::replace_in_range_name(std::string old_str,
+                                             std::string new_str)
+  : old_str(std::move(old_str)), new_str(std::move(new_str))
+{
+}
+
+void replace_in_range_name::operator()(range& r,
+                                       lazy_path const& abs_parent_path) const
+{
+  if (boost::algorithm::contains(r.name(), old_str))
+  {
+    auto new_name =
+        boost::algorithm::replace_all_copy(r.name(), old_str, new_str);
+    renamed_ranges.increment();
+    if (auto os = log(log_level::debug))
+      *os << abs_parent_path / r.name() << ": rename to " << new_name << '\n';
+    r.set_name(std::move(new_name));
+  }
+}
+
+change_color::change_color(std::string range_name, int rgb)
+  : range_name(range_name), rgb(rgb)
 {
-  return [old_str, new_str](range& r, fs::path const& abs_parent_path) {
-    if (boost::algorithm::contains(r.name(), old_str))
-    {
-      std::cout << abs_parent_path / r.name() << ": rename to ";
-      r.set_name(
-          boost::algorithm::replace_all_copy(r.name(), old_str, new_str));
-      std::cout << r.name() << std::endl;
-    }
-  };
 }
 
-range_action change_color(std::string const& range_name, int rgb)
+void change_color::operator()(range& r,
+                              lazy_path const& abs_parent_path) const
 {
-  return [range_name, rgb](range& r, fs::path const& abs_parent_path) {
-    if (r.name() == range_name && r.rgb() != rgb)
+  if (r.name_handle() == range_name && r.rgb() != rgb)
+  {
+    recolored_ranges.increment();
+    if (auto os = log(log_level::debug))
     {
-      std::cout << abs_parent_path / r.name() << ": changing color from "
-                << std::hex << r.rgb() << " to " << rgb << std::dec
-                << std::endl;
-      r.set_rgb(rgb);
+      *os << abs_parent_path / r.name() << ": changing color from " << std::hex
+          << r.rgb() << " to " << rgb << std::dec << '\n';
     }
-  };
+    r.set_rgb(rgb);
+  }
+}
+
+change_color_ends_with::change_color_ends_with(std::string str, int rgb)
+  : str(std::move(str)), rgb(rgb)
+{
 }
 
-range_action change_color_ends_with(std::string const& str, int rgb)
+void change_color_ends_with::operator()(range& r,
+                                        lazy_path const& abs_parent_path) const
 {
-  return [str, rgb](range& r, fs::path const& abs_parent_path) {
-    if (boost::algorithm::ends_with(r.name(), str) && r.rgb() != rgb)
+  if (boost::algorithm::ends_with(r.name(), str) && r.rgb() != rgb)
+  {
+    recolored_ranges.increment();
+    if (auto os = log(log_level::debug))
     {
-      std::cout << abs_parent_path / r.name() << ": changing color from "
-                << std::hex << r.rgb() << " to " << rgb << std::dec
-                << std::endl;
-      r.set_rgb(rgb);
+      *os << abs_parent_path / r.name() << ": changing color from " << std::hex
+          << r.rgb() << " to " << rgb << std::dec << '\n';
     }
-  };
+    r.set_rgb(rgb);
+  }
 }
 
-range_action set_unassigned_to_subrange(std::string const& range_name, int rgb)
+set_unassigned_to_subrange::set_unassigned_to_subrange(std::string range_name,
+                                                       int rgb)
+  : range_name(range_name), rgb(rgb)
 {
-  return [range_name, rgb](range& r, fs::path const& abs_parent_path) {
-    if (r.subranges().empty())
+}
+
+void set_unassigned_to_subrange::operator()(
+    range& r, lazy_path const& abs_parent_path) const
+{
+  if (r.subranges().empty())
+    return;
+  for (auto& sub : r.subranges())
+  {
+    if (sub.name_handle() == range_name)
       return;
-    for (auto& sub : r.subranges())
-    {
-      if (sub.name() == range_name)
-        return;
-    }
+  }
 
-    auto unassigned = prc::unassigned_elems(r);
-    if (!unassigned.empty())
+  auto unassigned = prc::unassigned_elems(r);
+  if (!unassigned.empty())
+  {
+    r.emplace_subrange(range_name.str(), std::move(unassigned), rgb);
+    unassigned_subranges.increment();
+    if (auto os = log(log_level::debug))
     {
-      r.add_subrange({range_name, std::move(unassigned), rgb});
-      std::cout << abs_parent_path / r.name() << ": set unassigned range to "
-                << range_name << std::endl;
+      *os << abs_parent_path / r.name() << ": set unassigned range to "
+          << range_name.str() << '\n';
     }
-  };
+  }
 }
 
-range_action move_subrange_at_end(std::string const& range_name)
+move_subrange_at_end::move_subrange_at_end(std::string range_name)
+  : range_name(range_name)
 {
-  return [range_name](range& r, fs::path const& abs_parent_path) {
-    auto const end = r.subranges().end();
-    auto it = std::find_if(r.subranges().begin(), end, [&](auto& s) {
-      return s.name() == range_name;
-    });
-    if (it != end)
-      std::rotate(it, it + 1, end);
-  };
 }
 
-range_action sort_subranges()
+void move_subrange_at_end::operator()(range& r,
+                                      lazy_path const& abs_parent_path) const
 {
-  return [](range& r, fs::path const& abs_parent_path) {
-    std::sort(r.subranges().begin(),
-              r.subranges().end(),
-              [](auto const& lhs, auto const& rhs) {
-                return rgb_to_range_types.at(lhs.rgb()) <
-                       rgb_to_range_types.at(rhs.rgb());
-              });
-  };
+  auto const end = r.subranges().end();
+  auto it = std::find_if(r.subranges().begin(), end, [&](auto& s) {
+    return s.name_handle() == range_name;
+  });
+  if (it != end)
+    std::rotate(it, it + 1, end);
 }
 
-range_action count_max_ranges()
+void sort_subranges::operator()(range& r,
+                                lazy_path const& abs_parent_path) const
 {
-  return [](range& r, fs::path const& abs_parent_path) {
-    std::cout << recurse_count_subranges(r) << " groups in "
-              << abs_parent_path / r.name() << std::endl;
-  };
+  std::sort(r.subranges().begin(),
+            r.subranges().end(),
+            [](auto const& lhs, auto const& rhs) {
+              return rgb_to_range_types.at(lhs.rgb()) <
+                     rgb_to_range_types.at(rhs.rgb());
+            });
 }
 
-// TODO refactor this mess
-range_action percents_to_bb()
+void count_max_ranges::operator()(range& r,
+                                  lazy_path const& abs_parent_path) const
 {
-  return [](range& r, fs::path const& abs_parent_path) {
-    if (!contains_percent(r))
-      return;
-    auto parts = parse_range_name(r.name());
-    if (parts.empty())
-      return;
+  if (auto os = log(log_level::info))
+  {
+    *os << recurse_count_subranges(r) << " groups in "
+        << abs_parent_path / r.name() << '\n';
+  }
+}
 
-    auto current_pot = 2.5;
-    auto last_bet = 1.0;
-    std::map<std::string, double> positions_last_bet{{"UTG", 0},
-                                                     {"UTG+1", 0},
-                                                     {"LJ", 0},
-                                                     {"HJ", 0},
-                                                     {"CO", 0},
-                                                     {"BTN", 0},
-                                                     {"SB", 0.5},
-                                                     {"BB", 1}};
-
-    // TODO refactor ends_with%
-    // keep track of last bet for every position, the count is messed up!!
-    // e.g. SB 0.5, BB 1.0
-    // if raise call then reraise and call, the count is broken!
-    for (auto& [pos, action] : parts)
-    {
-      if (action == "Fold")
-        continue;
-      else if (boost::algorithm::ends_with(action, "bb"))
-      {
-        double bbs = 0;
-        x3::phrase_parse(action.begin(),
-                         action.end(),
-                         x3::double_ >> x3::lit("bb"),
-                         x3::space,
-                         bbs);
-        last_bet = bbs;
-      }
-      else if (boost::algorithm::ends_with(action, "%"))
-      {
-        double percent = 0;
-        x3::phrase_parse(action.begin(),
-                         action.end(),
-                         x3::double_ >> x3::lit("%"),
-                         x3::space,
-                         percent);
-        auto const amount_to_call = last_bet - positions_last_bet.at(pos);
-        auto const new_last_bet =
-            last_bet + (current_pot + amount_to_call) * (percent / 100.f);
-        // when RFI percent is 28%, it gives 1.98, the actual percent is
-        // around 28.6, which is not in the range name
-        last_bet = std::max(new_last_bet, 2 * last_bet);
-        std::stringstream ss;
-        ss << std::fixed << std::setprecision(2) << last_bet;
-        action = ss.str();
-        if (action.back() == '0')
-          action.pop_back();
-        action += "bb";
-      }
-      current_pot += last_bet - positions_last_bet.at(pos);
-      positions_last_bet.at(pos) = last_bet;
-    }
+void percents_to_bb::operator()(range& r,
+                                lazy_path const& abs_parent_path) const
+{
+  if (!contains_percent(r))
+    return;
+  auto const line = find_action_line(r.name());
+  if (!line || line->empty())
+    return;
 
-    std::string new_str;
-    for (auto const& [pos, action] : parts)
-      new_str += pos + '_' + action + '_';
-    new_str.pop_back();
-    // don't care about nesting
-    for (auto& sub : r.subranges())
+  auto const& node = find_action_node(*line);
+  auto const& hero = line->back().position;
+  // don't care about nesting
+  for (auto& sub : r.subranges())
+  {
+    auto const sub_action = make_action({}, sub.name());
+    if (sub_action.type == action_type::percent)
     {
-      if (boost::algorithm::ends_with(sub.name(), "%"))
+      std::string action;
+      append_bb_amount(action,
+                       node.state.bet_size(hero, sub_action.amount));
+      if (auto os = log(log_level::debug))
       {
-        double percent = 0;
-        x3::phrase_parse(sub.name().begin(),
-                         sub.name().end(),
-                         x3::double_ >> x3::lit("%"),
-                         x3::space,
-                         percent);
-
-        auto const amount_to_call =
-            last_bet - positions_last_bet.at(parts.back().first);
-        auto const final_bet =
-            last_bet + (current_pot + amount_to_call) * (percent / 100.f);
-        std::stringstream ss;
-        ss << std::fixed << std::setprecision(2) << final_bet;
-        auto action = ss.str();
-        if (action.back() == '0')
-          action.pop_back();
-        action += "bb";
-        std::cout << abs_parent_path / r.name() / sub.name() << ": rename to "
-                  << action << std::endl;
-        sub.set_name(action);
+        *os << abs_parent_path / r.name() / sub.name() << ": rename to "
+            << action << '\n';
       }
+      sub.set_name(std::move(action));
     }
-    std::cout << abs_parent_path / r.name() << ": rename to " << new_str
-              << std::endl;
-    r.set_name(new_str);
-  };
+  }
+  converted_ranges.increment();
+  if (auto os = log(log_level::debug))
+    *os << abs_parent_path / r.name() << ": rename to " << node.name << '\n';
+  r.set_name(node.name);
 }
 }
 }
@@ -1,33 +1,126 @@
-#include <filesystem>
-#include <functional>
+#pragma once
+
+#include <string>
 
 #include <prc/folder.hpp>
+#include <prc/interned_name.hpp>
 #include <prc/range.hpp>
 
+#include "pipeline.hpp"
+
 namespace prc::actions
 {
-using range_action = std::function<void(range&, std::filesystem::path const&)>;
-using folder_action =
-    std::function<bool(folder&, std::filesystem::path const&)>;
+// Range actions are called with the range and the path of its parent, folder
+// actions with the folder and its path. Folder actions return whether they
+// must be applied to subfolders too. Actions declare what they modify, see
+// action_locality.
 
 inline namespace range_actions
 {
-range_action replace_in_range_name(std::string const& old_str,
-                                   std::string const& new_str);
-range_action change_color(std::string const& range_name, int rgb);
-range_action change_color_ends_with(std::string const& str, int rgb);
-range_action move_subrange_at_end(std::string const& range_name);
-range_action set_unassigned_to_subrange(std::string const& range_name, int rgb);
-range_action count_max_ranges();
-range_action sort_subranges();
-range_action percents_to_bb();
+struct replace_in_range_name
+{
+  static constexpr auto locality = action_locality::range;
+
+  replace_in_range_name(std::string old_str, std::string new_str);
+  void operator()(range&, lazy_path const&) const;
+
+  std::string old_str;
+  std::string new_str;
+};
+
+struct change_color
+{
+  static constexpr auto locality = action_locality::range;
+
+  change_color(std::string range_name, int rgb);
+  void operator()(range&, lazy_path const&) const;
+
+  interned_name range_name;
+  int rgb;
+};
+
+struct change_color_ends_with
+{
+  static constexpr auto locality = action_locality::range;
+
+  change_color_ends_with(std::string str, int rgb);
+  void operator()(range&, lazy_path const&) const;
+
+  std::string str;
+  int rgb;
+};
+
+struct move_subrange_at_end
+{
+  static constexpr auto locality = action_locality::range;
+
+  explicit move_subrange_at_end(std::string range_name);
+  void operator()(range&, lazy_path const&) const;
+
+  interned_name range_name;
+};
+
+struct set_unassigned_to_subrange
+{
+  static constexpr auto locality = action_locality::range;
+
+  set_unassigned_to_subrange(std::string range_name, int rgb);
+  void operator()(range&, lazy_path const&) const;
+
+  interned_name range_name;
+  int rgb;
+};
+
+struct count_max_ranges
+{
+  static constexpr auto locality = action_locality::range;
+
+  void operator()(range&, lazy_path const&) const;
+};
+
+struct sort_subranges
+{
+  static constexpr auto locality = action_locality::range;
+
+  void operator()(range&, lazy_path const&) const;
+};
+
+struct percents_to_bb
+{
+  static constexpr auto locality = action_locality::range;
+
+  void operator()(range&, lazy_path const&) const;
+};
 }
 
 inline namespace folder_actions
 {
-folder_action fix_parent_ranges();
-folder_action nest_parent_ranges();
-folder_action remove_useless_ranges();
-folder_action remove_empty_folders();
+struct fix_parent_ranges
+{
+  static constexpr auto locality = action_locality::folder;
+
+  bool operator()(folder&, lazy_path const&) const;
+};
+
+struct nest_parent_ranges
+{
+  static constexpr auto locality = action_locality::folder;
+
+  bool operator()(folder&, lazy_path const&) const;
+};
+
+struct remove_useless_ranges
+{
+  static constexpr auto locality = action_locality::folder;
+
+  bool operator()(folder&, lazy_path const&) const;
+};
+
+struct remove_empty_folders
+{
+  static constexpr auto locality = action_locality::folder;
+
+  bool operator()(folder&, lazy_path const&) const;
+};
 }
 }
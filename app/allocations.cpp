@@ -0,0 +1,59 @@
+#include <prc/detail/profile.hpp>
+
+#include <cstdlib>
+#include <new>
+
+// Counts allocations when profiling, replacing the global operator new and
+// its aligned form. The array and nothrow forms call these ones by default.
+namespace
+{
+prc::detail::profile_counter allocations{"allocations"};
+
+template <typename Allocate>
+void* allocate(Allocate&& alloc)
+{
+  allocations.add();
+  while (true)
+  {
+    if (auto const p = alloc())
+      return p;
+    if (auto const handler = std::get_new_handler())
+      handler();
+    else
+      throw std::bad_alloc{};
+  }
+}
+}
+
+void* operator new(std::size_t size)
+{
+  return allocate([&] { return std::malloc(size ? size : 1); });
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+  auto const align = static_cast<std::size_t>(alignment);
+  // aligned_alloc requires a non-zero multiple of the alignment
+  auto const rounded = size ? (size + align - 1) / align * align : align;
+  return allocate([&] { return std::aligned_alloc(align, rounded); });
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+  std::free(p);
+}
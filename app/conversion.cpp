@@ -0,0 +1,303 @@
+#include "conversion.hpp"
+#include "actions.hpp"
+#include "log.hpp"
+
+#include <fstream>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+
+#include <prc/deduplicate.hpp>
+#include <prc/detail/hash.hpp>
+#include <prc/detail/profile.hpp>
+#include <prc/detail/render_cache.hpp>
+#include <prc/equilab/parse.hpp>
+#include <prc/equilab/serialize.hpp>
+#include <prc/gtoplus/serialize.hpp>
+#include <prc/pio/manifest.hpp>
+#include <prc/pio/parse.hpp>
+#include <prc/pio/serialize.hpp>
+
+namespace fs = std::filesystem;
+
+using namespace std::string_literals;
+
+namespace prc::actions
+{
+namespace
+{
+log_counter written_files{"written pio files"};
+log_counter unchanged_files{"unchanged pio files"};
+log_counter removed_files{"removed pio files"};
+log_counter deduplicated_ranges{"ranges sharing their elems"};
+
+detail::profile_timer write_timer{"write files"};
+detail::profile_counter written_bytes{"bytes written"};
+detail::profile_timer pio_rename_pass_timer{"rename and remove ranges"};
+detail::profile_timer fix_parent_ranges_timer{"fix_parent_ranges"};
+detail::profile_timer pio_range_pass_timer{"percents_to_bb and subranges"};
+detail::profile_timer nest_parent_ranges_timer{"nest_parent_ranges"};
+detail::profile_timer remove_empty_folders_timer{"remove_empty_folders"};
+
+void write_file(fs::path const& path,
+                std::string_view content,
+                std::ios::openmode mode = {})
+{
+  detail::scoped_timer const timer{write_timer};
+  std::ofstream ofs{path.string(), mode | std::ios::trunc};
+  ofs.write(content.data(), content.size());
+  written_bytes.add(content.size());
+}
+
+void serialize_to_pio_impl(folder const& current_folder,
+                           fs::path const& current_abs_path,
+                           detail::render_cache& cache)
+{
+  for (auto& e : current_folder.entries())
+  {
+    if (auto r = boost::variant2::get_if<range>(&e))
+    {
+      auto const filename = current_abs_path / (r->name() + ".txt"s);
+      write_file(filename, pio::serialize(*r, cache));
+      written_files.increment();
+      if (auto os = log(log_level::debug))
+        *os << "Wrote " << filename << '\n';
+    }
+    else
+    {
+      auto const& subfolder = boost::variant2::get<folder>(e);
+      auto const subfolder_abs_path = current_abs_path / subfolder.name();
+      fs::create_directories(subfolder_abs_path);
+      if (auto os = log(log_level::debug))
+        *os << "Created " << subfolder_abs_path << '\n';
+      serialize_to_pio_impl(subfolder, subfolder_abs_path, cache);
+    }
+  }
+}
+
+void export_to_pio_impl(folder const& current_folder,
+                        fs::path const& dst,
+                        fs::path const& current_rel_path,
+                        pio_manifest const& old_manifest,
+                        pio_manifest& new_manifest,
+                        detail::render_cache& cache)
+{
+  for (auto& e : current_folder.entries())
+  {
+    if (auto r = boost::variant2::get_if<range>(&e))
+    {
+      auto const rel_path = current_rel_path / (r->name() + ".txt"s);
+      auto const filename = rel_path.generic_string();
+      auto const abs_path = dst / rel_path;
+      auto const content = pio::serialize(*r, cache);
+      auto const hash = detail::fnv1a(content);
+      new_manifest[filename] = hash;
+      if (pio::is_unchanged(old_manifest, filename, hash, dst))
+      {
+        unchanged_files.increment();
+        continue;
+      }
+      write_file(abs_path, content);
+      written_files.increment();
+      if (auto os = log(log_level::debug))
+        *os << "Wrote " << abs_path << '\n';
+    }
+    else
+    {
+      auto const& subfolder = boost::variant2::get<folder>(e);
+      auto const subfolder_rel_path = current_rel_path / subfolder.name();
+      fs::create_directories(dst / subfolder_rel_path);
+      export_to_pio_impl(subfolder,
+                         dst,
+                         subfolder_rel_path,
+                         old_manifest,
+                         new_manifest,
+                         cache);
+    }
+  }
+}
+
+void hash_pio_files_impl(folder const& current_folder,
+                         fs::path const& current_rel_path,
+                         pio_manifest& manifest,
+                         detail::render_cache& cache)
+{
+  for (auto& e : current_folder.entries())
+  {
+    if (auto r = boost::variant2::get_if<range>(&e))
+    {
+      auto const rel_path = current_rel_path / (r->name() + ".txt"s);
+      manifest[rel_path.generic_string()] =
+          detail::fnv1a(pio::serialize(*r, cache));
+    }
+    else
+    {
+      auto const& subfolder = boost::variant2::get<folder>(e);
+      hash_pio_files_impl(
+          subfolder, current_rel_path / subfolder.name(), manifest, cache);
+    }
+  }
+}
+}
+
+folder load_folder(fs::path const& src,
+                   std::string const& format,
+                   bool apply_actions,
+                   detail::thread_pool& pool)
+{
+  auto const src_path = fs::absolute(fs::canonical(src));
+  folder root;
+  if (format == "pio")
+  {
+    if (!fs::is_directory(src_path))
+    {
+      throw std::runtime_error{
+          "--src must point to a directory when --src-format=pio"};
+    }
+    root = pio::parse_folder(src_path);
+    if (apply_actions)
+      apply_pio_actions(root, pool);
+  }
+  else if (format == "equilab")
+  {
+    if (!fs::is_regular_file(src_path))
+    {
+      throw std::runtime_error{
+          "--src must point to a file when --src-format=equilab"};
+    }
+    root = equilab::parse(src_path);
+    if (apply_actions)
+      apply_equilab_actions(root, pool);
+  }
+  else
+    throw std::runtime_error{"unknown source format: " + format};
+  // identical elems are then serialized once
+  deduplicated_ranges.increment(deduplicate_elems(root));
+  return root;
+}
+
+void serialize_to_equilab(folder const& root,
+                          fs::path const& dst,
+                          detail::thread_pool& pool)
+{
+  fs::create_directories(dst.parent_path());
+  auto const equilab_content = equilab::serialize(root, &pool);
+  write_file(dst,
+             {reinterpret_cast<char const*>(equilab_content.data()),
+              2 * equilab_content.size()},
+             std::ios::binary);
+  if (auto os = log(log_level::info))
+    *os << "Wrote " << dst << '\n';
+}
+
+void serialize_to_gtoplus(folder const& root,
+                          fs::path const& dst,
+                          detail::thread_pool& pool)
+{
+  fs::create_directories(dst);
+  auto const [newdefs, settings] = gtoplus::serialize(root, &pool);
+  write_file(dst / "newdefs3.txt", newdefs, std::ios::binary);
+  if (auto os = log(log_level::info))
+    *os << "Wrote " << dst / "newdefs3.txt" << '\n';
+  write_file(dst / "settings.txt", settings);
+  if (auto os = log(log_level::info))
+    *os << "Wrote " << dst / "settings.txt" << '\n';
+}
+
+void serialize_to_pio(folder const& root,
+                      fs::path const& dst,
+                      fs::path const& tmp_path)
+{
+  fs::create_directories(tmp_path);
+  fs::create_directories(dst);
+  detail::render_cache cache;
+  serialize_to_pio_impl(root, tmp_path, cache);
+  fs::rename(tmp_path, dst);
+  if (auto os = log(log_level::info))
+    *os << "Renamed " << tmp_path << " to " << dst << '\n';
+}
+
+pio_manifest hash_pio_files(folder const& root)
+{
+  pio_manifest ret;
+  detail::render_cache cache;
+  hash_pio_files_impl(root, {}, ret, cache);
+  return ret;
+}
+
+pio_manifest export_to_pio(folder const& root, fs::path const& dst)
+{
+  fs::create_directories(dst);
+  auto const old_manifest = pio::read_manifest(dst);
+  pio_manifest new_manifest;
+  detail::render_cache cache;
+  export_to_pio_impl(root, dst, {}, old_manifest, new_manifest, cache);
+  for (auto const& path :
+       pio::remove_stale_files(old_manifest, new_manifest, dst))
+  {
+    removed_files.increment();
+    if (auto os = log(log_level::debug))
+      *os << "Removed " << path << '\n';
+  }
+  pio::write_manifest(new_manifest, dst);
+  if (auto os = log(log_level::info))
+    *os << "Updated " << pio::manifest_path(dst) << '\n';
+  return new_manifest;
+}
+
+void apply_pio_actions(folder& root, detail::thread_pool& pool)
+{
+  {
+    // ranges are renamed before removing the useless ones, in the same pass
+    detail::scoped_timer const timer{pio_rename_pass_timer};
+    apply_to_tree(pool,
+                  root,
+                  true,
+                  range_pipeline{
+                      replace_in_range_name("FOLD", "Fold"),
+                      replace_in_range_name("__", "%_"),
+                      replace_in_range_name("_POT", "%"),
+                      replace_in_range_name("POT", ""),
+                      replace_in_range_name("Raise1", "2.0bb"),
+                      change_color("Fold", 0xff6da2c0),
+                      change_color("AllIn", 0xff8b0000),
+                      change_color_ends_with("bb", 0xffe9967a),
+                      change_color_ends_with("%", 0xffe9967a),
+                  },
+                  remove_useless_ranges());
+  }
+  {
+    detail::scoped_timer const timer{fix_parent_ranges_timer};
+    apply_to_folders(pool, root, fix_parent_ranges());
+  }
+  detail::scoped_timer const timer{pio_range_pass_timer};
+  apply_to_ranges(pool,
+                  root,
+                  false,
+                  range_pipeline{percents_to_bb(),
+                                 set_unassigned_to_subrange("Fold", 0xff6da2c0),
+                                 sort_subranges()});
+}
+
+void apply_equilab_actions(folder& root, detail::thread_pool& pool)
+{
+  {
+    detail::scoped_timer const timer{nest_parent_ranges_timer};
+    actions::apply_to_folders(pool, root, actions::nest_parent_ranges());
+  }
+  detail::scoped_timer const timer{remove_empty_folders_timer};
+  actions::apply_to_folders(pool, root, actions::remove_empty_folders());
+  // apply_to_folders(root, actions::remove_useless_ranges());
+  // apply_to_ranges(root,
+  //                 true,
+  //                 {actions::replace_in_range_name("Raise1", "Raise"),
+  //                  actions::replace_in_range_name("UTG+4", "HJ"),
+  //                  actions::replace_in_range_name("UTG+3", "LJ"),
+  //                  actions::change_color_ends_with("bb", 0xffe9967a),
+  //                  actions::change_color_ends_with("%", 0xffe9967a),
+  //                  actions::change_color("66%", 0xffe9967a),
+  //                  actions::change_color("180%", 0xffe9967a)});
+  // apply_to_folders(root, actions::replace_in_folder_name("UTG+4", "HJ"));
+  // apply_to_folders(root, actions::replace_in_folder_name("UTG+3", "LJ"));
+}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+#include <prc/detail/thread_pool.hpp>
+#include <prc/folder.hpp>
+#include <prc/pio/manifest.hpp>
+
+namespace prc::actions
+{
+// parses a pio directory or an equilab file, applying the actions which make
+// it suitable for the other formats
+folder load_folder(std::filesystem::path const& src,
+                   std::string const& format,
+                   bool apply_actions,
+                   prc::detail::thread_pool& pool);
+
+// top-level subtrees are rendered concurrently on pool
+void serialize_to_equilab(folder const& root,
+                          std::filesystem::path const& dst,
+                          prc::detail::thread_pool& pool);
+void serialize_to_gtoplus(folder const& root,
+                          std::filesystem::path const& dst,
+                          prc::detail::thread_pool& pool);
+// pio files are written in tmp_path, then moved to dst
+void serialize_to_pio(folder const& root,
+                      std::filesystem::path const& dst,
+                      std::filesystem::path const& tmp_path);
+
+using pio_manifest = prc::pio::manifest;
+
+pio_manifest hash_pio_files(folder const& root);
+// Only writes files whose content changed since the last export, and removes
+// the ones which are not part of the library anymore. Returns the hashes of
+// the exported files.
+pio_manifest export_to_pio(folder const& root,
+                           std::filesystem::path const& dst);
+
+void apply_pio_actions(folder& root, prc::detail::thread_pool& pool);
+void apply_equilab_actions(folder& root, prc::detail::thread_pool& pool);
+}
@@ -0,0 +1,98 @@
+#include "log.hpp"
+
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace prc::actions
+{
+namespace
+{
+std::atomic<log_level> current_level{log_level::info};
+thread_local std::ostream* current_stream = nullptr;
+
+struct counter_registry
+{
+  std::mutex mutex;
+  std::vector<log_counter*> counters;
+};
+
+counter_registry& counters()
+{
+  static counter_registry ret;
+  return ret;
+}
+}
+
+void set_log_level(log_level level)
+{
+  current_level = level;
+}
+
+bool log_enabled(log_level level)
+{
+  return level <= current_level.load(std::memory_order_relaxed);
+}
+
+std::ostream* log(log_level level)
+{
+  return log_enabled(level) ? &log_stream() : nullptr;
+}
+
+std::ostream& log_stream()
+{
+  return current_stream ? *current_stream : std::cout;
+}
+
+scoped_log_redirect::scoped_log_redirect(std::ostream& os)
+  : _previous(current_stream)
+{
+  current_stream = &os;
+}
+
+scoped_log_redirect::~scoped_log_redirect()
+{
+  current_stream = _previous;
+}
+
+log_counter::log_counter(std::string name) : _name(std::move(name))
+{
+  auto& registry = counters();
+  std::lock_guard lock{registry.mutex};
+  registry.counters.push_back(this);
+}
+
+void log_counter::increment(std::size_t n)
+{
+  _value.fetch_add(n, std::memory_order_relaxed);
+}
+
+std::size_t log_counter::value() const
+{
+  return _value.load(std::memory_order_relaxed);
+}
+
+std::size_t log_counter::reset()
+{
+  return _value.exchange(0);
+}
+
+std::string const& log_counter::name() const
+{
+  return _name;
+}
+
+void write_counters()
+{
+  auto& registry = counters();
+  std::lock_guard lock{registry.mutex};
+  for (auto counter : registry.counters)
+  {
+    auto const value = counter->reset();
+    if (value == 0)
+      continue;
+    if (auto os = log(log_level::info))
+      *os << counter->name() << ": " << value << '\n';
+  }
+}
+}
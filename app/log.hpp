@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+#include <string>
+
+namespace prc::actions
+{
+enum class log_level
+{
+  error,
+  warning,
+  // summaries, e.g. counters and written files (default)
+  info,
+  // one line per modified node
+  debug,
+};
+
+void set_log_level(log_level);
+bool log_enabled(log_level);
+
+// Stream to write a message of that level to, nullptr when the level is
+// disabled so that the message is not even formatted:
+//
+//   if (auto os = log(log_level::debug))
+//     *os << path << ": renamed\n";
+//
+// Messages should end with '\n' rather than std::endl, output is flushed when
+// the program exits.
+std::ostream* log(log_level);
+// std::cout unless redirected for the current thread
+std::ostream& log_stream();
+
+// Redirects log_stream() of the current thread while alive.
+class scoped_log_redirect
+{
+public:
+  explicit scoped_log_redirect(std::ostream&);
+  ~scoped_log_redirect();
+
+  scoped_log_redirect(scoped_log_redirect const&) = delete;
+  scoped_log_redirect& operator=(scoped_log_redirect const&) = delete;
+
+private:
+  std::ostream* _previous;
+};
+
+// Counts what happened to every node (e.g. renamed ranges), to summarize
+// instead of logging a line per node. Counters must have static storage
+// duration, they register themselves.
+class log_counter
+{
+public:
+  explicit log_counter(std::string name);
+
+  log_counter(log_counter const&) = delete;
+  log_counter& operator=(log_counter const&) = delete;
+
+  void increment(std::size_t n = 1);
+  std::size_t value() const;
+  // returns the value before resetting it to 0
+  std::size_t reset();
+  std::string const& name() const;
+
+private:
+  std::string _name;
+  std::atomic<std::size_t> _value{0};
+};
+
+// writes non-zero counters at info level, then resets them
+void write_counters();
+}
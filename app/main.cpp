@@ -1,20 +1,31 @@
+#include <algorithm>
+#include <chrono>
+#include <exception>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 
 #include <lyra/lyra.hpp>
 
-#include <prc/equilab/parse.hpp>
+#include <prc/detail/profile.hpp>
+#include <prc/detail/thread_pool.hpp>
 #include <prc/equilab/serialize.hpp>
 #include <prc/folder.hpp>
-#include <prc/gtoplus/serialize.hpp>
 #include <prc/pio/parse.hpp>
-#include <prc/pio/serialize.hpp>
 
+#include <boost/algorithm/string.hpp>
 #include <boost/locale.hpp>
 #include <boost/spirit/home/x3.hpp>
 
 #include "actions.hpp"
+#include "conversion.hpp"
+#include "log.hpp"
+#include "repl.hpp"
 
 namespace fs = std::filesystem;
 namespace x3 = boost::spirit::x3;
@@ -25,193 +36,248 @@ using namespace prc;
 
 namespace
 {
-template <typename Callable>
-void apply_to_subranges(range& r, fs::path const& abs_parent_path, Callable&& c)
+using actions::log;
+using actions::log_level;
+
+// plain conversion without any action, each range is parsed, converted and
+// written before parsing the next one
+void stream_pio_to_equilab(fs::path const& src, fs::path const& dst)
 {
-  std::forward<Callable>(c)(r, abs_parent_path);
-  for (auto& sub : r.subranges())
-    apply_to_subranges(
-        sub, abs_parent_path / r.name(), std::forward<Callable>(c));
+  fs::create_directories(dst.parent_path());
+  std::ofstream ofs{dst.string(), std::ios::binary | std::ios::trunc};
+  equilab::stream_serializer serializer{ofs};
+  // like parse_folder, only write folders which contain at least one range
+  std::vector<std::pair<std::string, bool>> folders;
+
+  pio::walk_folder(src,
+                   {[&](auto const& name) {
+                      folders.emplace_back(name, false);
+                    },
+                    [&] {
+                      if (folders.back().second)
+                        serializer.close_folder();
+                      folders.pop_back();
+                    },
+                    [&](auto&& r) {
+                      for (auto& [name, opened] : folders)
+                      {
+                        if (!opened)
+                        {
+                          serializer.open_folder(name);
+                          opened = true;
+                        }
+                      }
+                      serializer.add_range(r);
+                    }});
+  if (auto os = log(log_level::info))
+    *os << "Wrote " << dst << '\n';
 }
 
-template <typename Callable>
-void apply_to_ranges_impl(folder& current_folder,
-                          fs::path const& current_path,
-                          bool recurse_subranges,
-                          Callable&& c)
+void write_profile_files(std::string const& profile_path,
+                         std::string const& trace_path)
 {
-  for (auto& e : current_folder.entries())
+  if (!profile_path.empty())
   {
-    if (auto r = boost::variant2::get_if<range>(&e))
-    {
-      if (recurse_subranges)
-        apply_to_subranges(*r, current_path, std::forward<Callable>(c));
-      else
-        c(*r, current_path / current_folder.name());
-    }
-    else
-    {
-      apply_to_ranges_impl(boost::variant2::get<folder>(e),
-                           current_path / current_folder.name(),
-                           recurse_subranges,
-                           std::forward<Callable>(c));
-    }
+    std::ofstream ofs{profile_path, std::ios::trunc};
+    detail::write_profile(ofs);
   }
-}
-
-template <typename Callable>
-void apply_to_folders_impl(folder& current_folder,
-                           fs::path const& current_path,
-                           Callable&& c)
-{
-  for (auto& e : current_folder.entries())
+  if (!trace_path.empty())
   {
-    if (auto f = boost::variant2::get_if<folder>(&e))
-    {
-      if (c(*f, current_path / f->name()))
-      {
-        apply_to_folders_impl(
-            *f, current_path / f->name(), std::forward<Callable>(c));
-      }
-    }
+    std::ofstream ofs{trace_path, std::ios::trunc};
+    detail::write_trace(ofs);
   }
 }
 
-void apply_to_ranges(
-    folder& root,
-    bool recurse_subranges,
-    std::vector<std::function<void(range&, fs::path const&)>> const& funcs)
+struct conversion_job
 {
-  apply_to_ranges_impl(root,
-                       fs::path{"/"} / root.name(),
-                       recurse_subranges,
-                       [&](auto& r, auto const& p) {
-                         for (auto const& f : funcs)
-                           f(r, p);
-                       });
-}
+  fs::path src;
+  std::string src_format;
+  fs::path dst;
+  std::string dst_format;
+  bool apply_actions = true;
+  bool incremental = false;
+};
 
-void apply_to_folders(folder& root,
-                      std::function<bool(folder&, fs::path const&)> const& func)
+// pio files are written in tmp_path, then moved to the destination
+void run_job(conversion_job const& job,
+             detail::thread_pool& pool,
+             fs::path const& tmp_path)
 {
-  auto ld = [&](auto& f, auto const& p) { return func(f, p); };
-  if (ld(root, root.name()))
-    apply_to_folders_impl(root, root.name(), ld);
-}
+  if (job.incremental && job.dst_format != "pio")
+    throw std::runtime_error{"--incremental requires --dst-format=pio"};
+  auto const root =
+      actions::load_folder(job.src, job.src_format, job.apply_actions, pool);
 
-void serialize_to_equilab(folder const& root, fs::path const& dst)
-{
-  fs::create_directories(dst.parent_path());
-  auto const equilab_content = equilab::serialize(root);
-  std::ofstream ofs{dst.string(), std::ios::binary | std::ios::trunc};
-  ofs.write(reinterpret_cast<char const*>(equilab_content.data()),
-            2 * equilab_content.size());
-  std::cout << "Wrote " << dst << std::endl;
+  if (job.dst_format == "equilab")
+    actions::serialize_to_equilab(root, job.dst, pool);
+  else if (job.dst_format == "pio" && job.incremental)
+    actions::export_to_pio(root, fs::absolute(job.dst));
+  else if (job.dst_format == "pio")
+    actions::serialize_to_pio(root, job.dst, tmp_path);
+  else if (job.dst_format == "gtoplus")
+    actions::serialize_to_gtoplus(root, job.dst, pool);
+  else
+    throw std::runtime_error{"unknown destination format: " + job.dst_format};
 }
 
-void serialize_to_gtoplus(folder const& root, fs::path const& dst)
+// One job per line, with tab-separated fields:
+//
+//   src  src-format  dst  dst-format  [actions|no-actions]
+//
+// Relative paths are relative to the manifest, empty lines and lines starting
+// with '#' are ignored.
+std::vector<conversion_job> read_batch_manifest(fs::path const& path,
+                                                bool incremental)
 {
-  fs::create_directories(dst);
-  auto const [newdefs, settings] = gtoplus::serialize(root);
-  std::ofstream newdefs_stream{(dst / "newdefs3.txt").string(),
-                               std::ios::binary | std::ios::trunc};
-  newdefs_stream.write(newdefs.data(), newdefs.size());
-  std::cout << "Wrote " << dst / "newdefs3.txt" << std::endl;
-  std::ofstream settings_stream((dst / "settings.txt").string(),
-                                std::ios::trunc);
-  settings_stream.write(settings.data(), settings.size());
-  std::cout << "Wrote " << dst / "settings.txt" << std::endl;
-}
-
-void serialize_to_pio_impl(folder const& current_folder,
-                           fs::path const& current_abs_path)
-{
-  for (auto& e : current_folder.entries())
+  std::ifstream ifs{path.string()};
+  if (!ifs)
+    throw std::runtime_error{"cannot open batch manifest " + path.string()};
+  auto const base_path = fs::absolute(path).parent_path();
+  std::vector<conversion_job> ret;
+  std::string line;
+  for (auto line_number = 1; std::getline(ifs, line); ++line_number)
   {
-    if (auto r = boost::variant2::get_if<range>(&e))
+    if (line.empty() || line.front() == '#')
+      continue;
+    std::vector<std::string> fields;
+    boost::algorithm::split(fields, line, [](char c) { return c == '\t'; });
+    if (fields.size() < 4 || fields.size() > 5 ||
+        (fields.size() == 5 && fields[4] != "actions" &&
+         fields[4] != "no-actions"))
     {
-      auto const filename = current_abs_path / (r->name() + ".txt"s);
-      std::ofstream ofs{filename.string(), std::ios::trunc};
-      auto const content = pio::serialize(*r);
-      ofs.write(content.data(), content.size());
-      std::cout << "Wrote " << filename << std::endl;
-    }
-    else
-    {
-      auto const& subfolder = boost::variant2::get<folder>(e);
-      auto const subfolder_abs_path = current_abs_path / subfolder.name();
-      fs::create_directories(subfolder_abs_path);
-      std::cout << "Created " << subfolder_abs_path << std::endl;
-      serialize_to_pio_impl(subfolder, subfolder_abs_path);
+      throw std::runtime_error{"invalid job at line " +
+                               std::to_string(line_number) + " of " +
+                               path.string()};
     }
+    ret.push_back({base_path / fields[0],
+                   fields[1],
+                   base_path / fields[2],
+                   fields[3],
+                   fields.size() == 4 || fields[4] == "actions",
+                   incremental && fields[3] == "pio"});
   }
+  return ret;
 }
 
-void serialize_to_pio(folder const& root, fs::path const& dst)
+struct job_result
 {
-  auto const tmp_path = fs::temp_directory_path() / "pio";
-  fs::create_directories(tmp_path);
-  fs::create_directories(dst);
-  serialize_to_pio_impl(root, tmp_path);
-  fs::rename(tmp_path, dst);
-  std::cout << "Renamed " << tmp_path << " to " << dst << std::endl;
-}
+  std::string log;
+  bool failed = false;
+  std::chrono::steady_clock::duration elapsed{};
+};
 
-void apply_pio_actions(folder& root)
+// Empty directory under the system temporary directory, which concurrent runs
+// do not share.
+fs::path make_unique_temp_directory(std::string const& prefix)
 {
-  apply_to_ranges(root,
-                  true,
-                  {
-                      actions::replace_in_range_name("FOLD", "Fold"),
-                      actions::replace_in_range_name("__", "%_"),
-                      actions::replace_in_range_name("_POT", "%"),
-                      actions::replace_in_range_name("POT", ""),
-                      actions::replace_in_range_name("Raise1", "2.0bb"),
-                      actions::change_color("Fold", 0xff6da2c0),
-                      actions::change_color("AllIn", 0xff8b0000),
-                      actions::change_color_ends_with("bb", 0xffe9967a),
-                      actions::change_color_ends_with("%", 0xffe9967a),
-                  });
-  apply_to_folders(root, actions::remove_useless_ranges());
-  apply_to_folders(root, actions::fix_parent_ranges());
-  apply_to_ranges(root,
-                  false,
-                  {actions::percents_to_bb(),
-                   actions::set_unassigned_to_subrange("Fold", 0xff6da2c0),
-                   actions::sort_subranges()});
+  std::random_device rd;
+  std::ostringstream name;
+  name << prefix << std::hex << rd() << rd();
+  auto const ret = fs::temp_directory_path() / name.str();
+  fs::remove_all(ret);
+  return ret;
 }
 
-void apply_equilab_actions(folder& root)
+// Runs every job of the manifest in this process, so that static tables and
+// caches (e.g. parsed range names) are only built once. Jobs run one after
+// the other, each parallelized on the whole pool, so that their timing only
+// covers their own work. Their logs are written in manifest order followed by
+// a timing summary.
+int run_batch(fs::path const& manifest,
+              detail::thread_pool& pool,
+              bool incremental)
 {
-  apply_to_folders(root, actions::nest_parent_ranges());
-  apply_to_folders(root, actions::remove_empty_folders());
-  // apply_to_folders(root, actions::remove_useless_ranges());
-  // apply_to_ranges(root,
-  //                 true,
-  //                 {actions::replace_in_range_name("Raise1", "Raise"),
-  //                  actions::replace_in_range_name("UTG+4", "HJ"),
-  //                  actions::replace_in_range_name("UTG+3", "LJ"),
-  //                  actions::change_color_ends_with("bb", 0xffe9967a),
-  //                  actions::change_color_ends_with("%", 0xffe9967a),
-  //                  actions::change_color("66%", 0xffe9967a),
-  //                  actions::change_color("180%", 0xffe9967a)});
-  // apply_to_folders(root, actions::replace_in_folder_name("UTG+4", "HJ"));
-  // apply_to_folders(root, actions::replace_in_folder_name("UTG+3", "LJ"));
+  auto const batch = read_batch_manifest(manifest, incremental);
+  std::vector<job_result> results(batch.size());
+  for (std::size_t i = 0; i < batch.size(); ++i)
+  {
+    std::ostringstream os;
+    auto const start = std::chrono::steady_clock::now();
+    {
+      actions::scoped_log_redirect const redirect{os};
+      try
+      {
+        run_job(batch[i], pool, make_unique_temp_directory("pio_job"));
+      }
+      catch (std::exception const& e)
+      {
+        results[i].failed = true;
+        if (auto es = log(log_level::error))
+          *es << "Error: " << e.what() << '\n';
+      }
+    }
+    results[i].elapsed = std::chrono::steady_clock::now() - start;
+    results[i].log = os.str();
+  }
+
+  auto nb_failed = 0;
+  for (auto const& r : results)
+  {
+    actions::log_stream() << r.log;
+    nb_failed += r.failed;
+  }
+  if (auto os = log(log_level::info))
+  {
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+      auto const ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+          results[i].elapsed);
+      *os << batch[i].src << " -> " << batch[i].dst << ": "
+          << (results[i].failed ? "failed" : "done") << " in " << ms.count()
+          << "ms\n";
+    }
+  }
+  if (auto os = log(nb_failed ? log_level::error : log_level::info))
+    *os << nb_failed << '/' << batch.size() << " jobs failed\n";
+  return nb_failed ? -1 : 0;
 }
 }
 
 int main(int argc, char const* argv[])
 {
   auto show_help = false;
+  auto stream = false;
+  auto incremental = false;
+  auto verbose = false;
+  auto quiet = false;
+  auto repl = false;
+  std::size_t jobs = std::max(1u, std::thread::hardware_concurrency());
   std::string src;
   std::string src_format;
   std::string dst_format;
   std::string dst;
+  std::string batch;
+  std::string socket;
+  std::string profile;
+  std::string trace;
 
-  auto cli = lyra::help(show_help) | lyra::opt(src, "src")["--src"].required() |
-             lyra::opt(src_format, "src format")["--src-format"].required() |
-             lyra::opt(dst_format, "dst format")["--dst-format"].required() |
-             lyra::opt(dst, "dst")["--dst"].required();
+  auto cli = lyra::help(show_help) | lyra::opt(src, "src")["--src"] |
+             lyra::opt(src_format, "src format")["--src-format"] |
+             lyra::opt(dst_format, "dst format")["--dst-format"] |
+             lyra::opt(dst, "dst")["--dst"] |
+             lyra::opt(batch, "manifest")["--batch"].help(
+                 "run every conversion listed in the manifest, one per line: "
+                 "src, src format, dst, dst format and optionally "
+                 "actions/no-actions, separated by tabs") |
+             lyra::opt(repl)["--repl"].help(
+                 "load --src once, then read commands from stdin (see help)") |
+             lyra::opt(socket, "socket")["--socket"].help(
+                 "same as --repl, reading commands from a UNIX socket") |
+             lyra::opt(stream)["--stream"].help(
+                 "convert pio to equilab one range at a time, no actions are "
+                 "applied") |
+             lyra::opt(incremental)["--incremental"].help(
+                 "only write pio files whose content changed") |
+             lyra::opt(jobs, "jobs")["--jobs"].help(
+                 "number of threads used to apply actions and to write "
+                 "equilab and gtoplus files") |
+             lyra::opt(verbose)["-v"]["--verbose"].help(
+                 "log every modified range and written file") |
+             lyra::opt(quiet)["-q"]["--quiet"].help("only log errors") |
+             lyra::opt(profile, "json")["--profile"].help(
+                 "write the time spent in each phase and various counters") |
+             lyra::opt(trace, "json")["--trace"].help(
+                 "write every timed phase in the Chrome trace event format");
   if (auto res = cli.parse({argc, argv}); !res)
   {
     std::cout << "Error in command line: " << res.errorMessage() << std::endl;
@@ -222,37 +288,80 @@ int main(int argc, char const* argv[])
     std::cout << cli << std::endl;
     return 0;
   }
-  auto const src_path = fs::absolute(fs::canonical(src));
-  auto const dst_path = dst;
-  // TODO repl
-  folder root;
-  if (src_format == "pio")
+  repl = repl || !socket.empty();
+  if (repl && (src.empty() || src_format.empty()))
   {
-    if (!fs::is_directory(src_path))
+    std::cout << "Error in command line: --src and --src-format are required "
+                 "with --repl"
+              << std::endl;
+    return -1;
+  }
+  if (!repl && batch.empty() &&
+      (src.empty() || src_format.empty() || dst.empty() || dst_format.empty()))
+  {
+    std::cout << "Error in command line: --src, --src-format, --dst and "
+                 "--dst-format are required without --batch"
+              << std::endl;
+    return -1;
+  }
+  // logs are flushed on exit rather than after every line
+  std::ios::sync_with_stdio(false);
+  if (quiet)
+    actions::set_log_level(log_level::error);
+  else if (verbose)
+    actions::set_log_level(log_level::debug);
+  if (!trace.empty())
+    detail::set_profile_mode(detail::profile_mode::trace);
+  else if (!profile.empty())
+    detail::set_profile_mode(detail::profile_mode::summary);
+  if (stream)
+  {
+    auto const src_path = fs::absolute(fs::canonical(src));
+    if (src_format != "pio" || dst_format != "equilab" ||
+        !fs::is_directory(src_path))
     {
-      std::cout << "--src must point to a directory when --src-format=pio"
+      std::cout << "--stream requires a pio directory as --src and "
+                   "--dst-format=equilab"
                 << std::endl;
       return -1;
     }
-    root = pio::parse_folder(src_path);
-    apply_pio_actions(root);
+    stream_pio_to_equilab(src_path, dst);
+    actions::write_counters();
+    write_profile_files(profile, trace);
+    return 0;
   }
-  else if (src_format == "equilab")
+  jobs = std::max<std::size_t>(jobs, 1);
+  // the main thread helps while waiting, hence one worker less
+  detail::thread_pool pool{jobs - 1};
+  auto ret = 0;
+  try
   {
-    if (!fs::is_regular_file(src_path))
+    if (repl)
     {
-      std::cout << "--src must point to a file when --src-format=equilab"
-                << std::endl;
-      return -1;
+      actions::repl_session session{
+          actions::load_folder(src, src_format, true, pool), pool};
+      actions::write_counters();
+      if (socket.empty())
+        actions::run_repl(session, std::cin, std::cout);
+      else
+        actions::serve_repl(session, socket);
+    }
+    else if (!batch.empty())
+      ret = run_batch(batch, pool, incremental);
+    else
+    {
+      run_job({src, src_format, dst, dst_format, true, incremental},
+              pool,
+              fs::temp_directory_path() / "pio");
     }
-    root = equilab::parse(src_path);
-    apply_equilab_actions(root);
   }
-
-  if (dst_format == "equilab")
-    serialize_to_equilab(root, dst_path);
-  else if (dst_format == "pio")
-    serialize_to_pio(root, dst_path);
-  else if (dst_format == "gtoplus")
-    serialize_to_gtoplus(root, dst_path);
+  catch (std::exception const& e)
+  {
+    if (auto os = log(log_level::error))
+      *os << "Error: " << e.what() << '\n';
+    ret = -1;
+  }
+  actions::write_counters();
+  write_profile_files(profile, trace);
+  return ret;
 }
@@ -0,0 +1,36 @@
+#include "pipeline.hpp"
+
+#include <ostream>
+
+namespace fs = std::filesystem;
+
+namespace prc::actions
+{
+lazy_path::lazy_path(std::string const& root_name) : _name(&root_name)
+{
+}
+
+lazy_path::lazy_path(lazy_path const& parent, std::string const& name)
+  : _parent(&parent), _name(&name)
+{
+}
+
+fs::path lazy_path::path() const
+{
+  if (!_parent)
+    return fs::path{"/"} / *_name;
+  return _parent->path() / *_name;
+}
+
+fs::path lazy_path::operator/(std::string const& name) const
+{
+  return path() / name;
+}
+
+void write_logs(folder_task const& task, std::ostream& os)
+{
+  os << task.log;
+  for (auto const& child : task.children)
+    write_logs(*child, os);
+}
+}
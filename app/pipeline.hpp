@@ -0,0 +1,344 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <prc/detail/thread_pool.hpp>
+#include <prc/folder.hpp>
+#include <prc/range.hpp>
+
+#include "log.hpp"
+
+namespace prc::actions
+{
+enum class action_locality
+{
+  // only modifies the given range and its subranges
+  range,
+  // only modifies the given folder and its subtree
+  folder,
+  // anything else, never applied in parallel
+  global,
+};
+
+// actions without a locality member are global
+template <typename Action, typename = void>
+struct locality_of
+  : std::integral_constant<action_locality, action_locality::global>
+{
+};
+
+template <typename Action>
+struct locality_of<Action, std::void_t<decltype(Action::locality)>>
+  : std::integral_constant<action_locality, Action::locality>
+{
+};
+
+// Path of a folder or range during a traversal. It only refers to the names
+// of the node and its parents, and is built when asked for (e.g. to log).
+class lazy_path
+{
+public:
+  // the root folder, its path is /name
+  explicit lazy_path(std::string const& root_name);
+  lazy_path(lazy_path const& parent, std::string const& name);
+  lazy_path(lazy_path const&, std::string&&) = delete;
+
+  std::filesystem::path path() const;
+  // path of a child named name
+  std::filesystem::path operator/(std::string const& name) const;
+
+private:
+  lazy_path const* _parent{};
+  std::string const* _name;
+};
+
+// Placeholder for a traversal which only applies range or folder actions.
+struct no_action
+{
+  template <typename T>
+  bool operator()(T&, lazy_path const&) const
+  {
+    return true;
+  }
+};
+
+// Applies several range actions one after the other to each range, in a
+// single traversal.
+template <typename... Actions>
+class range_pipeline
+{
+public:
+  static constexpr auto locality =
+      ((locality_of<Actions>::value == action_locality::range) && ...)
+          ? action_locality::range
+          : action_locality::global;
+
+  explicit range_pipeline(Actions... actions) : _actions(std::move(actions)...)
+  {
+  }
+
+  void operator()(range& r, lazy_path const& parent_path) const
+  {
+    std::apply([&](auto const&... actions) { (actions(r, parent_path), ...); },
+               _actions);
+  }
+
+private:
+  std::tuple<Actions...> _actions;
+};
+
+template <typename RangeAction>
+void apply_to_subranges(range& r,
+                        lazy_path const& parent_path,
+                        RangeAction const& range_action)
+{
+  range_action(r, parent_path);
+  lazy_path const path{parent_path, r.name()};
+  for (auto& sub : r.subranges())
+    apply_to_subranges(sub, path, range_action);
+}
+
+template <typename RangeAction, typename FolderAction>
+void apply_to_tree_impl(folder& f,
+                        lazy_path const& path,
+                        bool recurse_subranges,
+                        RangeAction const& range_action,
+                        FolderAction const& folder_action,
+                        bool apply_folder_action)
+{
+  constexpr auto has_range_action = !std::is_same_v<RangeAction, no_action>;
+  if constexpr (has_range_action)
+  {
+    for (auto& e : f.entries())
+    {
+      if (auto r = boost::variant2::get_if<range>(&e))
+      {
+        if (recurse_subranges)
+          apply_to_subranges(*r, path, range_action);
+        else
+          range_action(*r, path);
+      }
+    }
+  }
+  // a folder action returning false is not applied to subfolders
+  if (apply_folder_action)
+    apply_folder_action = folder_action(f, path);
+  if (!has_range_action && !apply_folder_action)
+    return;
+  for (auto& e : f.entries())
+  {
+    if (auto sub = boost::variant2::get_if<folder>(&e))
+    {
+      apply_to_tree_impl(*sub,
+                         lazy_path{path, sub->name()},
+                         recurse_subranges,
+                         range_action,
+                         folder_action,
+                         apply_folder_action);
+    }
+  }
+}
+
+// Single pre-order traversal: in each folder, range_action is applied to the
+// ranges (and their subranges when recurse_subranges is set), then
+// folder_action to the folder itself.
+template <typename RangeAction, typename FolderAction>
+void apply_to_tree(folder& root,
+                   bool recurse_subranges,
+                   RangeAction const& range_action,
+                   FolderAction const& folder_action)
+{
+  apply_to_tree_impl(root,
+                     lazy_path{root.name()},
+                     recurse_subranges,
+                     range_action,
+                     folder_action,
+                     true);
+}
+
+template <typename RangeAction>
+void apply_to_ranges(folder& root,
+                     bool recurse_subranges,
+                     RangeAction const& range_action)
+{
+  apply_to_tree(root, recurse_subranges, range_action, no_action{});
+}
+
+template <typename FolderAction>
+void apply_to_folders(folder& root, FolderAction const& folder_action)
+{
+  apply_to_tree(root, false, no_action{}, folder_action);
+}
+
+// Folder visited by apply_to_tree in parallel, kept until every task is done
+// to write the logs in the same order as the sequential traversal.
+struct folder_task
+{
+  folder_task(folder& f, lazy_path path) : f(&f), path(std::move(path))
+  {
+  }
+
+  folder* f;
+  lazy_path path;
+  std::string log;
+  std::vector<std::unique_ptr<folder_task>> children;
+};
+
+void write_logs(folder_task const&, std::ostream&);
+
+template <typename Action>
+constexpr bool can_run_in_parallel(action_locality locality)
+{
+  return std::is_same_v<Action, no_action> ||
+         locality_of<Action>::value == locality;
+}
+
+// ranges of a folder are split in chunks of that size, applied in parallel
+inline constexpr std::size_t range_chunk_size = 64;
+
+template <typename RangeAction, typename FolderAction>
+void apply_to_tree_task(prc::detail::thread_pool& pool,
+                        prc::detail::task_group& group,
+                        folder_task& task,
+                        bool recurse_subranges,
+                        RangeAction const& range_action,
+                        FolderAction const& folder_action,
+                        bool apply_folder_action)
+{
+  constexpr auto has_range_action = !std::is_same_v<RangeAction, no_action>;
+  if constexpr (has_range_action)
+  {
+    std::vector<range*> ranges;
+    for (auto& e : task.f->entries())
+    {
+      if (auto r = boost::variant2::get_if<range>(&e))
+        ranges.push_back(r);
+    }
+    auto const nb_chunks =
+        (ranges.size() + range_chunk_size - 1) / range_chunk_size;
+    std::vector<std::string> logs(nb_chunks);
+    auto const apply_to_chunk = [&](std::size_t chunk) {
+      std::ostringstream os;
+      scoped_log_redirect const redirect{os};
+      auto const last =
+          std::min(ranges.size(), (chunk + 1) * range_chunk_size);
+      for (auto i = chunk * range_chunk_size; i < last; ++i)
+      {
+        if (recurse_subranges)
+          apply_to_subranges(*ranges[i], task.path, range_action);
+        else
+          range_action(*ranges[i], task.path);
+      }
+      logs[chunk] = os.str();
+    };
+    if (nb_chunks == 1)
+      apply_to_chunk(0);
+    else if (nb_chunks > 1)
+    {
+      prc::detail::task_group chunks;
+      for (std::size_t i = 0; i < nb_chunks; ++i)
+        pool.submit(chunks, [&apply_to_chunk, i] { apply_to_chunk(i); });
+      pool.wait(chunks);
+    }
+    for (auto const& l : logs)
+      task.log += l;
+  }
+  if (apply_folder_action)
+  {
+    std::ostringstream os;
+    {
+      scoped_log_redirect const redirect{os};
+      apply_folder_action = folder_action(*task.f, task.path);
+    }
+    task.log += os.str();
+  }
+  if (!has_range_action && !apply_folder_action)
+    return;
+  // subfolders are independent once the folder action is done
+  for (auto& e : task.f->entries())
+  {
+    if (auto sub = boost::variant2::get_if<folder>(&e))
+    {
+      task.children.push_back(std::make_unique<folder_task>(
+          *sub, lazy_path{task.path, sub->name()}));
+    }
+  }
+  for (auto& child : task.children)
+  {
+    pool.submit(group,
+                [&pool,
+                 &group,
+                 &range_action,
+                 &folder_action,
+                 child = child.get(),
+                 recurse_subranges,
+                 apply_folder_action] {
+      apply_to_tree_task(pool,
+                         group,
+                         *child,
+                         recurse_subranges,
+                         range_action,
+                         folder_action,
+                         apply_folder_action);
+    });
+  }
+}
+
+// Same as apply_to_tree, subtrees are processed on the pool when the actions
+// are local. Logs are buffered and written once every subtree is done.
+template <typename RangeAction, typename FolderAction>
+void apply_to_tree(prc::detail::thread_pool& pool,
+                   folder& root,
+                   bool recurse_subranges,
+                   RangeAction const& range_action,
+                   FolderAction const& folder_action)
+{
+  constexpr auto is_local =
+      can_run_in_parallel<RangeAction>(action_locality::range) &&
+      can_run_in_parallel<FolderAction>(action_locality::folder);
+  if (!is_local || pool.nb_workers() == 0)
+  {
+    apply_to_tree(root, recurse_subranges, range_action, folder_action);
+    return;
+  }
+  folder_task root_task{root, lazy_path{root.name()}};
+  prc::detail::task_group group;
+  pool.submit(group, [&] {
+    apply_to_tree_task(pool,
+                       group,
+                       root_task,
+                       recurse_subranges,
+                       range_action,
+                       folder_action,
+                       true);
+  });
+  pool.wait(group);
+  write_logs(root_task, log_stream());
+}
+
+template <typename RangeAction>
+void apply_to_ranges(prc::detail::thread_pool& pool,
+                     folder& root,
+                     bool recurse_subranges,
+                     RangeAction const& range_action)
+{
+  apply_to_tree(pool, root, recurse_subranges, range_action, no_action{});
+}
+
+template <typename FolderAction>
+void apply_to_folders(prc::detail::thread_pool& pool,
+                      folder& root,
+                      FolderAction const& folder_action)
+{
+  apply_to_tree(pool, root, false, no_action{}, folder_action);
+}
+}
@@ -0,0 +1,440 @@
+#include "repl.hpp"
+#include "actions.hpp"
+#include "log.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+
+#include <boost/algorithm/string.hpp>
+
+#if __has_include(<sys/un.h>)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#define PRC_HAS_UNIX_SOCKETS
+#endif
+
+namespace fs = std::filesystem;
+
+namespace prc::actions
+{
+namespace
+{
+auto const help_message =
+    "load <pio|equilab> <src>    replace the library, applying the usual "
+    "actions\n"
+    "ls [path]                   list a folder, or the subranges of a range\n"
+    "find <str>                  list ranges whose name contains str\n"
+    "paths <prefix>              list paths starting with prefix\n"
+    "rm <path>                   remove a folder or range\n"
+    "undo                        revert the last load, apply or rm\n"
+    "apply replace <old> <new>   replace old by new in range names\n"
+    "apply color <name> <rgb>    change the color of ranges named name\n"
+    "apply pio-actions           actions applied when loading pio files\n"
+    "apply equilab-actions       actions applied when loading equilab files\n"
+    "diff                        ranges changed since loading or exporting\n"
+    "export <format> <dst>       write the library, pio exports only write "
+    "changed files\n"
+    "quit                        end the session\n"
+    "shutdown                    stop serving the socket\n";
+
+void find_in_range(range const& r,
+                   std::string const& path,
+                   std::string const& str,
+                   std::ostream& out)
+{
+  auto const range_path = path + '/' + r.name();
+  if (boost::algorithm::contains(r.name(), str))
+    out << range_path << '\n';
+  for (auto const& sub : r.subranges())
+    find_in_range(sub, range_path, str, out);
+}
+
+void find_in_folder(folder const& f,
+                    std::string const& path,
+                    std::string const& str,
+                    std::ostream& out)
+{
+  for (auto const& e : f.entries())
+  {
+    if (auto r = boost::variant2::get_if<range>(&e))
+      find_in_range(*r, path, str, out);
+    else
+    {
+      auto const& subfolder = boost::variant2::get<folder>(e);
+      find_in_folder(subfolder, path + '/' + subfolder.name(), str, out);
+    }
+  }
+}
+
+// "UTG/UTG_strategy.txt" -> "/UTG/UTG_strategy"
+std::string range_path(std::string const& pio_filename)
+{
+  return '/' + boost::algorithm::erase_tail_copy(pio_filename, 4);
+}
+
+void check_nb_args(std::vector<std::string> const& args, std::size_t n)
+{
+  if (args.size() != n)
+    throw std::runtime_error{"wrong number of arguments, see help"};
+}
+}
+
+repl_session::repl_session(folder root, prc::detail::thread_pool& pool)
+  : _root{std::move(root)}, _pool{pool}, _baseline{hash_pio_files(_root)}
+{
+}
+
+bool repl_session::execute(std::string const& line, std::ostream& out)
+{
+  std::vector<std::string> args;
+  auto const trimmed = boost::algorithm::trim_copy(line);
+  if (trimmed.empty())
+    return true;
+  boost::algorithm::split(args,
+                          trimmed,
+                          boost::algorithm::is_space(),
+                          boost::algorithm::token_compress_on);
+  auto const& command = args.front();
+  scoped_log_redirect const redirect{out};
+  try
+  {
+    if (command == "help")
+      out << help_message;
+    else if (command == "load")
+    {
+      check_nb_args(args, 3);
+      load(args[1], args[2]);
+    }
+    else if (command == "ls")
+      list(args.size() > 1 ? args[1] : "/", out);
+    else if (command == "find")
+    {
+      check_nb_args(args, 2);
+      find(args[1], out);
+    }
+    else if (command == "paths")
+    {
+      check_nb_args(args, 2);
+      for (auto const& path : paths().list(args[1]))
+        out << path << '\n';
+    }
+    else if (command == "rm")
+    {
+      check_nb_args(args, 2);
+      remove(args[1]);
+    }
+    else if (command == "undo")
+      undo();
+    else if (command == "apply")
+      apply(args);
+    else if (command == "diff")
+      diff(out);
+    else if (command == "export")
+    {
+      check_nb_args(args, 3);
+      export_to(args[1], args[2]);
+    }
+    else if (command == "quit")
+      return false;
+    else if (command == "shutdown")
+    {
+      _shutdown = true;
+      return false;
+    }
+    else
+      throw std::runtime_error{"unknown command " + command + ", see help"};
+  }
+  catch (std::exception const& e)
+  {
+    if (auto os = log(log_level::error))
+      *os << "Error: " << e.what() << '\n';
+  }
+  write_counters();
+  return true;
+}
+
+bool repl_session::shutdown_requested() const
+{
+  return _shutdown;
+}
+
+void repl_session::save_snapshot()
+{
+  // folders and ranges are copy-on-write, a snapshot only costs what is
+  // modified afterwards
+  _history.push_back(_root);
+  if (_history.size() > max_history)
+    _history.pop_front();
+}
+
+void repl_session::undo()
+{
+  if (_history.empty())
+    throw std::runtime_error{"nothing to undo"};
+  _root = std::move(_history.back());
+  _history.pop_back();
+  _paths.reset();
+}
+
+void repl_session::load(std::string const& format, fs::path const& src)
+{
+  auto root = load_folder(src, format, true, _pool);
+  save_snapshot();
+  _root = std::move(root);
+  _paths.reset();
+  _baseline = hash_pio_files(_root);
+}
+
+path_index& repl_session::paths()
+{
+  if (!_paths)
+    _paths.emplace(_root);
+  return *_paths;
+}
+
+void repl_session::list(std::string const& path, std::ostream& out)
+{
+  auto const target = paths().find(path);
+  if (target.r)
+  {
+    for (auto const& sub : target.r->subranges())
+      out << sub.name() << '\n';
+  }
+  else if (target.f)
+  {
+    for (auto const& e : target.f->entries())
+    {
+      if (auto f = boost::variant2::get_if<folder>(&e))
+        out << f->name() << "/\n";
+      else
+        out << boost::variant2::get<range>(e).name() << '\n';
+    }
+  }
+  else
+    throw std::runtime_error{"no such folder or range: " + path};
+}
+
+void repl_session::remove(std::string const& path)
+{
+  save_snapshot();
+  if (!paths().remove(path))
+  {
+    _history.pop_back();
+    throw std::runtime_error{"no such folder or range: " + path};
+  }
+}
+
+void repl_session::find(std::string const& str, std::ostream& out) const
+{
+  find_in_folder(_root, "", str, out);
+}
+
+void repl_session::apply(std::vector<std::string> const& args)
+{
+  if (args.size() < 2)
+    throw std::runtime_error{"missing action, see help"};
+  save_snapshot();
+  // actions rename and move entries
+  _paths.reset();
+  try
+  {
+    apply_action(args);
+  }
+  catch (...)
+  {
+    // leave the library as it was before a failed or partial action
+    undo();
+    throw;
+  }
+}
+
+void repl_session::apply_action(std::vector<std::string> const& args)
+{
+  auto const& action = args[1];
+  if (action == "replace")
+  {
+    check_nb_args(args, 4);
+    apply_to_ranges(
+        _pool, _root, true, replace_in_range_name(args[2], args[3]));
+  }
+  else if (action == "color")
+  {
+    check_nb_args(args, 4);
+    auto const rgb = static_cast<int>(std::stoll(args[3], nullptr, 0));
+    apply_to_ranges(_pool, _root, true, change_color(args[2], rgb));
+  }
+  else if (action == "pio-actions")
+    apply_pio_actions(_root, _pool);
+  else if (action == "equilab-actions")
+    apply_equilab_actions(_root, _pool);
+  else
+    throw std::runtime_error{"unknown action " + action + ", see help"};
+}
+
+void repl_session::diff(std::ostream& out) const
+{
+  auto const current = hash_pio_files(_root);
+  auto old_it = _baseline.begin();
+  auto it = current.begin();
+  // both are sorted by path
+  while (old_it != _baseline.end() || it != current.end())
+  {
+    if (it == current.end() ||
+        (old_it != _baseline.end() && old_it->first < it->first))
+      out << "- " << range_path((old_it++)->first) << '\n';
+    else if (old_it == _baseline.end() || it->first < old_it->first)
+      out << "+ " << range_path((it++)->first) << '\n';
+    else
+    {
+      if (it->second != old_it->second)
+        out << "M " << range_path(it->first) << '\n';
+      ++it;
+      ++old_it;
+    }
+  }
+}
+
+void repl_session::export_to(std::string const& format, fs::path const& dst)
+{
+  if (format == "equilab")
+    serialize_to_equilab(_root, dst, _pool);
+  else if (format == "gtoplus")
+    serialize_to_gtoplus(_root, dst, _pool);
+  else if (format == "pio")
+  {
+    _baseline = export_to_pio(_root, fs::absolute(dst));
+    return;
+  }
+  else
+    throw std::runtime_error{"unknown destination format: " + format};
+  _baseline = hash_pio_files(_root);
+}
+
+void run_repl(repl_session& session, std::istream& in, std::ostream& out)
+{
+  std::string line;
+  while (std::getline(in, line))
+  {
+    auto const keep_going = session.execute(line, out);
+    out.flush();
+    if (!keep_going)
+      break;
+  }
+}
+
+#ifdef PRC_HAS_UNIX_SOCKETS
+namespace
+{
+class file_descriptor
+{
+public:
+  explicit file_descriptor(int fd) : _fd{fd}
+  {
+    if (_fd < 0)
+      throw std::system_error{errno, std::generic_category()};
+  }
+
+  ~file_descriptor()
+  {
+    ::close(_fd);
+  }
+
+  file_descriptor(file_descriptor const&) = delete;
+  file_descriptor& operator=(file_descriptor const&) = delete;
+
+  int get() const
+  {
+    return _fd;
+  }
+
+private:
+  int _fd;
+};
+
+void send_all(int fd, std::string const& data)
+{
+#ifdef MSG_NOSIGNAL
+  auto const flags = MSG_NOSIGNAL;
+#else
+  auto const flags = 0;
+#endif
+  std::size_t sent = 0;
+  while (sent < data.size())
+  {
+    auto const n = ::send(fd, data.data() + sent, data.size() - sent, flags);
+    if (n < 0 && errno == EINTR)
+      continue;
+    // the client went away
+    if (n <= 0)
+      return;
+    sent += n;
+  }
+}
+
+void serve_client(repl_session& session, int fd)
+{
+  std::string pending;
+  char buffer[4096];
+  while (true)
+  {
+    auto const n = ::read(fd, buffer, sizeof(buffer));
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n <= 0)
+      return;
+    pending.append(buffer, n);
+    std::size_t pos;
+    while ((pos = pending.find('\n')) != std::string::npos)
+    {
+      std::ostringstream out;
+      auto const keep_going = session.execute(pending.substr(0, pos), out);
+      pending.erase(0, pos + 1);
+      out << ".\n";
+      send_all(fd, out.str());
+      if (!keep_going)
+        return;
+    }
+  }
+}
+}
+
+void serve_repl(repl_session& session, fs::path const& socket_path)
+{
+  sockaddr_un addr{};
+  addr.sun_family = AF_UNIX;
+  auto const path = socket_path.string();
+  if (path.size() >= sizeof(addr.sun_path))
+    throw std::runtime_error{"socket path is too long: " + path};
+  std::copy(path.begin(), path.end(), addr.sun_path);
+
+  file_descriptor const server{::socket(AF_UNIX, SOCK_STREAM, 0)};
+  fs::remove(socket_path);
+  if (::bind(server.get(), reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) <
+          0 ||
+      ::listen(server.get(), 1) < 0)
+    throw std::system_error{errno, std::generic_category(), path};
+  if (auto os = log(log_level::info))
+    *os << "Listening on " << socket_path << '\n' << std::flush;
+  while (!session.shutdown_requested())
+  {
+    auto const fd = ::accept(server.get(), nullptr, nullptr);
+    if (fd < 0 && errno == EINTR)
+      continue;
+    file_descriptor const client{fd};
+    serve_client(session, client.get());
+  }
+  fs::remove(socket_path);
+}
+#else
+void serve_repl(repl_session&, fs::path const&)
+{
+  throw std::runtime_error{"UNIX sockets are not supported on this platform"};
+}
+#endif
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <prc/detail/thread_pool.hpp>
+#include <prc/folder.hpp>
+#include <prc/path_index.hpp>
+
+#include "conversion.hpp"
+
+namespace prc::actions
+{
+// Keeps a library in memory between commands, so that it is parsed once and
+// can be queried, modified and exported many times. "help" lists commands.
+class repl_session
+{
+public:
+  repl_session(folder root, prc::detail::thread_pool& pool);
+
+  repl_session(repl_session const&) = delete;
+  repl_session& operator=(repl_session const&) = delete;
+
+  // returns false when the client asked to quit
+  bool execute(std::string const& line, std::ostream& out);
+  bool shutdown_requested() const;
+
+private:
+  void load(std::string const& format, std::filesystem::path const& src);
+  void list(std::string const& path, std::ostream& out);
+  void remove(std::string const& path);
+  void find(std::string const& str, std::ostream& out) const;
+  void apply(std::vector<std::string> const& args);
+  void apply_action(std::vector<std::string> const& args);
+  void diff(std::ostream& out) const;
+  void export_to(std::string const& format, std::filesystem::path const& dst);
+  void save_snapshot();
+  void undo();
+  // built on first use after loading or applying actions
+  path_index& paths();
+
+  folder _root;
+  prc::detail::thread_pool& _pool;
+  // pio files hashes when the library was loaded or last exported
+  pio_manifest _baseline;
+  std::optional<path_index> _paths;
+  // libraries before the last modifying commands, the most recent last
+  static constexpr std::size_t max_history = 16;
+  std::deque<folder> _history;
+  bool _shutdown{false};
+};
+
+// reads commands until the end of the input or "quit"
+void run_repl(repl_session&, std::istream&, std::ostream&);
+// Serves one client at a time on a UNIX socket until a client sends
+// "shutdown". Every response ends with a line containing a single '.'.
+void serve_repl(repl_session&, std::filesystem::path const& socket_path);
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iosfwd>
 #include <string>
 
@@ -16,14 +19,18 @@ public:
   card(prc::rank r, prc::suit s);
   explicit card(parser::ast::card);
 
-  prc::rank const& rank() const;
-  prc::suit const& suit() const;
+  // id must be lower than 52
+  static card from_id(std::uint8_t id);
+
+  prc::rank rank() const;
+  prc::suit suit() const;
+  // rank * 4 + suit, ordered as cards are
+  std::uint8_t id() const;
 
   std::string string() const;
 
 private:
-  prc::rank _r;
-  prc::suit _s;
+  std::uint8_t _id = 0;
 };
 
 bool operator==(card const&, card const&) noexcept;
@@ -32,3 +39,15 @@ bool operator<(card const&, card const&) noexcept;
 
 std::ostream& operator<<(std::ostream&, card const&);
 }
+
+namespace std
+{
+template <>
+struct hash<prc::card>
+{
+  std::size_t operator()(prc::card const& c) const noexcept
+  {
+    return c.id();
+  }
+};
+}
@@ -5,6 +5,12 @@
 #include <prc/rank.hpp>
 #include <prc/suit.hpp>
 
+#include <boost/container/small_vector.hpp>
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iosfwd>
 #include <stdexcept>
 #include <string>
@@ -15,6 +21,9 @@ namespace prc
 class range_elem;
 class hand;
 
+// Most weights only have a few elems, which are then stored inline.
+using range_elems = boost::container::small_vector<range_elem, 8>;
+
 class combo
 {
 public:
@@ -22,8 +31,16 @@ public:
   combo(card, card);
   explicit combo(parser::ast::combo const&);
 
-  card const& high() const;
-  card const& low() const;
+  // unchecked, id must be lower than 1326
+  static combo from_id(std::uint16_t id);
+  // unchecked, high must be greater than low
+  static combo from_ordered(card high, card low);
+
+  card high() const;
+  card low() const;
+  // high * (high - 1) / 2 + low with card ids, ordered as combos are, see
+  // combo_index
+  std::uint16_t id() const;
 
   std::string string() const;
 
@@ -32,8 +49,7 @@ public:
   bool paired() const;
 
 private:
-  card _high;
-  card _low;
+  std::uint16_t _id = 0;
 };
 
 struct weighted_combo
@@ -49,12 +65,38 @@ bool operator<(combo const&, combo const&) noexcept;
 std::ostream& operator<<(std::ostream&, combo const&);
 
 std::vector<combo> expand_combos(range_elem const&);
-std::vector<combo> expand_combos(std::vector<range_elem> const&);
-std::vector<hand> expand_hands(std::vector<range_elem> const&);
+std::vector<combo> expand_combos(range_elems const&);
+std::vector<hand> expand_hands(range_elems const&);
+
+// Combos as a mask, cheap to fill and to merge. Converting back to range
+// elems only happens in reduce_combos.
+class combo_set
+{
+public:
+  combo_set() = default;
+  explicit combo_set(range_elems const&);
+
+  void insert(combo const&);
+  void insert(range_elem const&);
+  void insert(range_elems const&);
+
+  combo_set& operator|=(combo_set const&);
+
+  bool contains(combo const&) const;
+  std::size_t size() const;
+  bool empty() const;
 
-std::vector<range_elem> reduce_combos(std::vector<combo> const&);
+private:
+  std::bitset<1326> _combos;
+};
+
+// position of the combo in any_two_combos()
+std::size_t combo_index(combo const&);
 
-std::vector<range_elem> const& any_two();
+range_elems reduce_combos(std::vector<combo> const&);
+range_elems reduce_combos(combo_set const&);
+
+range_elems const& any_two();
 std::vector<prc::combo> const& any_two_combos();
 
 std::vector<prc::combo> generate_all_combos();
@@ -69,3 +111,15 @@ inline namespace literals
 combo operator"" _c(char const*, std::size_t);
 }
 }
+
+namespace std
+{
+template <>
+struct hash<prc::combo>
+{
+  std::size_t operator()(prc::combo const& c) const noexcept
+  {
+    return c.id();
+  }
+};
+}
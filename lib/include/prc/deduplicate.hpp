@@ -0,0 +1,14 @@
+#pragma once
+
+#include <prc/folder.hpp>
+#include <prc/range.hpp>
+
+#include <cstddef>
+
+namespace prc
+{
+// Makes ranges and subranges with equal elems share a single copy of them,
+// found by hashing. Returns the number of ranges which now share another's
+// elems. Serializers render shared elems once, see detail::render_cache.
+std::size_t deduplicate_elems(folder&);
+}
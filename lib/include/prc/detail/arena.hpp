@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+namespace prc::detail
+{
+// memory resource of the calling thread's innermost scoped_arena, the
+// default resource outside of one
+std::pmr::memory_resource* current_arena();
+
+// Polymorphic allocator which default constructs to current_arena(), so that
+// containers created by code which knows nothing of arenas (e.g. parser
+// attributes) still allocate from one. Containers keep their resource once
+// constructed.
+template <typename T>
+class arena_allocator : public std::pmr::polymorphic_allocator<T>
+{
+public:
+  using std::pmr::polymorphic_allocator<T>::polymorphic_allocator;
+
+  arena_allocator() noexcept
+    : std::pmr::polymorphic_allocator<T>{current_arena()}
+  {
+  }
+
+  template <typename U>
+  arena_allocator(arena_allocator<U> const& other) noexcept
+    : std::pmr::polymorphic_allocator<T>{other.resource()}
+  {
+  }
+
+  template <typename U>
+  struct rebind
+  {
+    using other = arena_allocator<U>;
+  };
+
+  arena_allocator select_on_container_copy_construction() const
+  {
+    return {};
+  }
+};
+
+template <typename T>
+using arena_vector = std::vector<T, arena_allocator<T>>;
+
+// Monotonic resource installed as current_arena() for the lifetime of the
+// scope: allocations are a pointer bump and deallocations are no-ops, all
+// memory is released at once when the scope ends. The outermost arena of a
+// thread starts from a buffer kept for the thread's lifetime, so repeated
+// scopes (e.g. one per parsed file) do not touch the heap until they outgrow
+// it.
+//
+// Whatever allocates from the arena must be destroyed before it.
+class scoped_arena
+{
+public:
+  scoped_arena();
+  ~scoped_arena();
+
+  scoped_arena(scoped_arena const&) = delete;
+  scoped_arena& operator=(scoped_arena const&) = delete;
+
+private:
+  std::pmr::memory_resource* _previous;
+  bool _owns_thread_buffer;
+  std::pmr::monotonic_buffer_resource _resource;
+};
+}
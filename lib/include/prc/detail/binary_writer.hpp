@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace prc::detail
+{
+// Appends little-endian fields to a single growing buffer, without creating
+// temporaries for each field.
+class binary_writer
+{
+public:
+  binary_writer() = default;
+  explicit binary_writer(std::size_t capacity);
+
+  void reserve(std::size_t capacity);
+
+  void write_byte(std::uint8_t);
+  void write_word(std::uint16_t);
+  void write_dword(std::int32_t);
+  void write_double(double);
+  void write_bytes(std::string_view);
+  // encodes UTF-8 input as UTF-16LE code units, without any length prefix
+  void write_utf16le(std::string_view utf8);
+
+  std::size_t size() const;
+  std::string const& buffer() const;
+  std::string release();
+
+private:
+  std::string _buffer;
+};
+
+std::size_t utf16_length(std::string_view utf8);
+}
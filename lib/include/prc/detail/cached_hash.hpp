@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace prc::detail
+{
+// Hash of the enclosing value, computed on first use and copied along with
+// it. The value must reset() it whenever it may be modified.
+//
+// Values sharing their content (see cow) can be hashed from different
+// threads: they compute and store the same hash.
+class cached_hash
+{
+public:
+  cached_hash() = default;
+
+  cached_hash(cached_hash const& other) noexcept
+    : _hash{other._hash.load(std::memory_order_relaxed)}
+  {
+  }
+
+  // the moved-from value is left empty, or at least modified
+  cached_hash(cached_hash&& other) noexcept
+    : _hash{other._hash.exchange(not_computed, std::memory_order_relaxed)}
+  {
+  }
+
+  cached_hash& operator=(cached_hash const& other) noexcept
+  {
+    _hash.store(other._hash.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+    return *this;
+  }
+
+  cached_hash& operator=(cached_hash&& other) noexcept
+  {
+    _hash.store(other._hash.exchange(not_computed, std::memory_order_relaxed),
+                std::memory_order_relaxed);
+    return *this;
+  }
+
+  template <typename Compute>
+  std::size_t get(Compute&& compute) const
+  {
+    auto h = _hash.load(std::memory_order_relaxed);
+    if (h == not_computed)
+    {
+      h = compute();
+      if (h == not_computed)
+        ++h;
+      _hash.store(h, std::memory_order_relaxed);
+    }
+    return h;
+  }
+
+  void reset() noexcept
+  {
+    _hash.store(not_computed, std::memory_order_relaxed);
+  }
+
+private:
+  static constexpr std::size_t not_computed = 0;
+
+  mutable std::atomic<std::size_t> _hash{not_computed};
+};
+}
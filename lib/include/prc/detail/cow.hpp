@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace prc::detail
+{
+// Value shared between copies until one of them is modified: copying is a
+// reference count increment, and mut() clones the value only when it is
+// shared. An empty cow behaves as a default constructed T. Copies which
+// were not modified return the same object from get().
+//
+// As with any value, a given cow must not be modified concurrently, but
+// copies sharing the same value can be modified from different threads.
+template <typename T>
+class cow
+{
+public:
+  cow() = default;
+
+  explicit cow(T value) : _p{std::make_shared<T>(std::move(value))}
+  {
+  }
+
+  T const& get() const
+  {
+    if (!_p)
+      return empty();
+    return *_p;
+  }
+
+  // another copy refers to the same value, only a hint when copies are
+  // modified concurrently
+  bool shared() const
+  {
+    return _p.use_count() > 1;
+  }
+
+  T& mut()
+  {
+    if (!_p)
+      _p = std::make_shared<T>();
+    else if (_p.use_count() != 1)
+      _p = std::make_shared<T>(*_p);
+    else
+    {
+      // pairs with the release of the last other reference, whose reads of
+      // the value must happen before our writes
+      std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return *_p;
+  }
+
+private:
+  static T const& empty()
+  {
+    static T const value{};
+    return value;
+  }
+
+  std::shared_ptr<T> _p;
+};
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <charconv>
+#include <string>
+
+namespace prc::detail
+{
+// Locale-free floating point formatting, shared by every serializer.
+//
+// fixed notation trims trailing zeros, keeping at least min_decimals digits
+// after the decimal point (e.g. 3.00 -> "3", or "3.0" when min_decimals is 1).
+struct float_format
+{
+  std::chars_format notation;
+  int precision;
+  int min_decimals = 0;
+};
+
+inline constexpr float_format equilab_weight_format{std::chars_format::fixed,
+                                                    6};
+inline constexpr float_format pio_weight_format{std::chars_format::fixed, 3};
+// same output as the default std::ostream formatting
+inline constexpr float_format gtoplus_weight_format{std::chars_format::general,
+                                                    6};
+
+void append_double(std::string& out, double d, float_format const& fmt);
+std::string format_double(double d, float_format const& fmt);
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace prc::detail
+{
+// 64-bit FNV-1a, unlike std::hash its value is stable across runs and
+// platforms, so it can be stored on disk.
+inline constexpr std::uint64_t fnv1a_offset_basis = 0xcbf29ce484222325;
+
+std::uint64_t fnv1a(std::string_view bytes,
+                    std::uint64_t seed = fnv1a_offset_basis);
+
+// 16 lowercase hex digits
+std::string to_hex(std::uint64_t);
+bool from_hex(std::string_view, std::uint64_t&);
+}
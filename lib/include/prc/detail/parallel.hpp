@@ -0,0 +1,37 @@
+#pragma once
+
+#include <prc/detail/thread_pool.hpp>
+#include <prc/folder.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace prc::detail
+{
+// Part of a folder tree which can be serialized independently, either a whole
+// entry, or only the header of a folder whose entries are split in other
+// chunks.
+struct subtree_chunk
+{
+  folder::entry const* entry;
+  folder const* header;
+  int depth;
+};
+
+// Splits the entries of root (at depth 1) into chunks, descending into
+// subfolders until there are at least min_chunks of them. Serializing chunks
+// in order gives the same result as serializing the root entries.
+std::vector<subtree_chunk> split_subtrees(folder const& root,
+                                          std::size_t min_chunks);
+
+// Calls c(i) for every i in [0, n) as tasks of pool, the calling thread
+// taking part. The first exception thrown is rethrown once all calls are done.
+template <typename Callable>
+void parallel_for(thread_pool& pool, std::size_t n, Callable&& c)
+{
+  task_group group;
+  for (std::size_t i = 0; i < n; ++i)
+    pool.submit(group, [&c, i] { c(i); });
+  pool.wait(group);
+}
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace prc::detail
+{
+// Timers and counters which only cost a relaxed atomic load when profiling is
+// disabled, so that they can stay in release builds. They must have static
+// storage duration, they register themselves:
+//
+//   profile_timer parse_timer{"pio::parse_range"};
+//
+//   scoped_timer const timer{parse_timer};
+//
+// When tracing, every timed scope is also recorded with its thread.
+enum class profile_mode
+{
+  disabled,
+  summary,
+  trace,
+};
+
+inline std::atomic<profile_mode> active_profile_mode{profile_mode::disabled};
+
+void set_profile_mode(profile_mode);
+
+inline bool profiling_enabled()
+{
+  return active_profile_mode.load(std::memory_order_relaxed) !=
+         profile_mode::disabled;
+}
+
+class profile_counter
+{
+public:
+  explicit profile_counter(std::string name);
+
+  profile_counter(profile_counter const&) = delete;
+  profile_counter& operator=(profile_counter const&) = delete;
+
+  void add(std::size_t n = 1)
+  {
+    if (profiling_enabled())
+      _value.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  std::size_t value() const;
+  std::string const& name() const;
+
+private:
+  std::string _name;
+  std::atomic<std::size_t> _value{0};
+};
+
+class profile_timer
+{
+public:
+  using clock = std::chrono::steady_clock;
+
+  explicit profile_timer(std::string name);
+
+  profile_timer(profile_timer const&) = delete;
+  profile_timer& operator=(profile_timer const&) = delete;
+
+  void record(clock::time_point start, clock::time_point end);
+
+  std::size_t count() const;
+  std::chrono::nanoseconds total() const;
+  std::string const& name() const;
+
+private:
+  std::string _name;
+  std::atomic<std::size_t> _count{0};
+  std::atomic<std::int64_t> _total_ns{0};
+};
+
+class scoped_timer
+{
+public:
+  explicit scoped_timer(profile_timer& timer)
+    : _timer{profiling_enabled() ? &timer : nullptr}
+  {
+    if (_timer)
+      _start = profile_timer::clock::now();
+  }
+
+  ~scoped_timer()
+  {
+    if (_timer)
+      _timer->record(_start, profile_timer::clock::now());
+  }
+
+  scoped_timer(scoped_timer const&) = delete;
+  scoped_timer& operator=(scoped_timer const&) = delete;
+
+private:
+  profile_timer* _timer;
+  profile_timer::clock::time_point _start;
+};
+
+// JSON object with the totals of every timer and counter which was used
+void write_profile(std::ostream&);
+// Chrome trace event format, empty unless the mode was profile_mode::trace
+void write_trace(std::ostream&);
+}
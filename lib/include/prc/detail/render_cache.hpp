@@ -0,0 +1,40 @@
+#pragma once
+
+#include <prc/range.hpp>
+
+#include <string>
+#include <unordered_map>
+
+namespace prc::detail
+{
+// Serialized elems of the ranges which share them (see deduplicate_elems),
+// so that they are only rendered once. It must not outlive the ranges it is
+// used with, nor be used while they are modified.
+class render_cache
+{
+public:
+  // render(std::string&) appends the serialized elems of r
+  template <typename Render>
+  std::string const& get(range const& r, Render&& render)
+  {
+    if (!r.shares_elems())
+    {
+      _scratch.clear();
+      render(_scratch);
+      return _scratch;
+    }
+    auto const [it, inserted] = _rendered.try_emplace(&r.elems());
+    if (inserted)
+      render(it->second);
+    else
+      record_reuse();
+    return it->second;
+  }
+
+private:
+  static void record_reuse();
+
+  std::unordered_map<void const*, std::string> _rendered;
+  std::string _scratch;
+};
+}
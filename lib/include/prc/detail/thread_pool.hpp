@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace prc::detail
+{
+// Tasks submitted together, which can be waited for.
+class task_group
+{
+public:
+  task_group() = default;
+  task_group(task_group const&) = delete;
+  task_group& operator=(task_group const&) = delete;
+
+private:
+  friend class thread_pool;
+
+  // decremented under _mutex, so that a waiter which saw it reach zero
+  // holding _mutex can destroy the group
+  std::atomic<std::size_t> _pending{0};
+  std::mutex _mutex;
+  std::condition_variable _done;
+  std::exception_ptr _error;
+};
+
+// Work-stealing pool: each worker pops the tasks it submitted from the back of
+// its own queue, and steals from the front of the others when it is empty.
+// Threads waiting for a group run pending tasks in the meantime, so tasks can
+// submit and wait for subtasks, and a pool without workers still works. Once
+// there is nothing left to run, they sleep until the group's last task is done.
+class thread_pool
+{
+public:
+  explicit thread_pool(std::size_t nb_workers);
+  ~thread_pool();
+
+  thread_pool(thread_pool const&) = delete;
+  thread_pool& operator=(thread_pool const&) = delete;
+
+  std::size_t nb_workers() const;
+
+  void submit(task_group&, std::function<void()>);
+  // returns once every task of the group is done, the first exception thrown
+  // by one of them is rethrown
+  void wait(task_group&);
+
+private:
+  struct task
+  {
+    std::function<void()> func;
+    task_group* group;
+  };
+
+  struct queue
+  {
+    std::mutex mutex;
+    std::deque<task> tasks;
+  };
+
+  std::size_t current_queue() const;
+  bool try_run_one(std::size_t queue_index);
+  static void finish(task_group&);
+  void work(std::size_t queue_index);
+
+  // one per worker, the last one is shared by other threads
+  std::vector<std::unique_ptr<queue>> _queues;
+  std::vector<std::thread> _workers;
+  std::mutex _sleep_mutex;
+  std::condition_variable _wake_up;
+  std::size_t _nb_queued{0};
+  bool _stop{false};
+};
+}
@@ -2,16 +2,19 @@
 
 #include <optional>
 #include <string>
-#include <vector>
 
 #include <boost/fusion/include/io.hpp>
 #include <boost/fusion/support/pair.hpp>
 #include <boost/variant.hpp>
 
+#include <prc/detail/arena.hpp>
 #include <prc/parser/ast.hpp>
 
 namespace prc::equilab::parser::ast
 {
+// Only live for the duration of equilab::parse, which runs in a scoped_arena.
+using hands = detail::arena_vector<prc::parser::ast::range_elem>;
+
 struct group_info
 {
   int index;
@@ -24,12 +27,12 @@ struct group_info
 struct weighted_hands
 {
   double weight;
-  std::vector<prc::parser::ast::range_elem> hands;
+  ast::hands hands;
 };
 
 struct group
 {
-  std::vector<ast::weighted_hands> weighted_hands;
+  detail::arena_vector<ast::weighted_hands> weighted_hands;
   std::optional<ast::group_info> info;
 };
 
@@ -37,7 +40,7 @@ struct range
 {
   int depth;
   std::string name;
-  std::vector<group> groups;
+  detail::arena_vector<group> groups;
   std::optional<std::string> note;
 };
 
@@ -1,11 +1,33 @@
 #pragma once
 
+#include <iosfwd>
 #include <string>
 #include <vector>
 
+#include <prc/detail/thread_pool.hpp>
 #include <prc/folder.hpp>
 
 namespace prc::equilab
 {
-std::u16string serialize(prc::folder const&);
+// With a pool, top-level subtrees are rendered concurrently on it.
+std::u16string serialize(prc::folder const&,
+                         prc::detail::thread_pool* pool = nullptr);
+
+// Writes the same content as serialize, one entry at a time, so that the
+// whole tree never has to be kept in memory.
+class stream_serializer
+{
+public:
+  explicit stream_serializer(std::ostream&);
+
+  void open_folder(std::string const& name);
+  void close_folder();
+  void add_range(prc::range const&);
+
+private:
+  void write(std::string const& utf8);
+
+  std::ostream& _os;
+  int _depth{1};
+};
 }
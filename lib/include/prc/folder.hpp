@@ -1,13 +1,19 @@
 #pragma once
 
+#include <prc/detail/cached_hash.hpp>
+#include <prc/detail/cow.hpp>
 #include <prc/equilab/parser/ast.hpp>
+#include <prc/interned_name.hpp>
 #include <prc/pio/parser/ast.hpp>
 #include <prc/range.hpp>
 
 #include <boost/variant2/variant.hpp>
 
+#include <cstddef>
 #include <filesystem>
+#include <functional>
 #include <iosfwd>
+#include <utility>
 #include <vector>
 
 namespace prc
@@ -22,21 +28,54 @@ public:
   folder(std::string name, std::vector<equilab::parser::ast::entry> const&);
 
   void add_entry(folder const&);
+  void add_entry(folder&&);
   void add_entry(range const&);
+  void add_entry(range&&);
+  // constructs a folder or a range from args after the last entry
+  template <typename T, typename... Args>
+  T& emplace_entry(Args&&... args);
   void remove_entry(std::string const& name);
   void set_name(std::string);
 
   std::string const& name() const;
+  interned_name name_handle() const;
   std::vector<entry> const& entries() const;
 
   std::vector<entry>& entries();
 
+  // of the name and entries, computed once until the folder is modified, see
+  // range::hash
+  std::size_t hash() const;
+
 private:
-  std::string _name;
-  std::vector<entry> _entries;
+  interned_name _name;
+  // shared between copies, entries() clones them before modifying
+  detail::cow<std::vector<entry>> _entries;
+  detail::cached_hash _hash;
 };
 
+template <typename T, typename... Args>
+T& folder::emplace_entry(Args&&... args)
+{
+  _hash.reset();
+  auto& e = _entries.mut().emplace_back(boost::variant2::in_place_type<T>,
+                                        std::forward<Args>(args)...);
+  return boost::variant2::get<T>(e);
+}
+
 bool operator==(folder const& lhs, folder const& rhs);
 bool operator!=(folder const& lhs, folder const& rhs);
 std::ostream& operator<<(std::ostream&, folder const&);
 }
+
+namespace std
+{
+template <>
+struct hash<prc::folder>
+{
+  std::size_t operator()(prc::folder const& f) const
+  {
+    return f.hash();
+  }
+};
+}
@@ -2,6 +2,7 @@
 
 #include <string>
 
+#include <prc/detail/thread_pool.hpp>
 #include <prc/folder.hpp>
 
 namespace prc::gtoplus
@@ -12,5 +13,7 @@ struct serialized_content
   std::string settings;
 };
 
-serialized_content serialize(prc::folder const&);
+// With a pool, top-level subtrees are rendered concurrently on it.
+serialized_content serialize(prc::folder const&,
+                             prc::detail::thread_pool* pool = nullptr);
 }
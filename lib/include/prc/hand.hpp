@@ -6,12 +6,19 @@
 
 #include <boost/variant2/variant.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iosfwd>
 #include <optional>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 namespace prc
 {
+// Paired or unpaired hand, stored as its id. Accessors return unpacked
+// values, not references.
 class hand
 {
 public:
@@ -20,6 +27,9 @@ public:
   explicit hand(paired_hand);
   explicit hand(parser::ast::hand const&);
 
+  // id must be lower than 169
+  static hand from_id(std::uint8_t id);
+
   template <typename T>
   bool holds_alternative() const;
 
@@ -29,18 +39,25 @@ public:
   int index() const;
 
   template <typename T>
-  T const& get() const;
+  T get() const;
 
   template <typename Callable>
   decltype(auto) visit(Callable&&) const;
 
+  // pairs by rank, then unpaired hands by high rank, low rank and
+  // suitedness: ordered as hands are
+  std::uint8_t id() const;
+
   std::string string() const;
 
   friend bool operator==(hand const& lhs, hand const& rhs);
   friend bool operator<(hand const& lhs, hand const& rhs);
 
 private:
-  boost::variant2::variant<paired_hand, unpaired_hand> _v;
+  paired_hand to_paired_hand() const;
+  unpaired_hand to_unpaired_hand() const;
+
+  std::uint8_t _id = 0;
 };
 
 bool operator!=(hand const& lhs, hand const& rhs);
@@ -49,27 +66,57 @@ std::ostream& operator<<(std::ostream&, hand const&);
 template <typename T>
 bool hand::holds_alternative() const
 {
-  return boost::variant2::holds_alternative<T>(_v);
+  if constexpr (std::is_same_v<T, paired_hand>)
+    return index() == 0;
+  else
+  {
+    static_assert(std::is_same_v<T, unpaired_hand>);
+    return index() == 1;
+  }
 }
 
 template <typename T>
 std::optional<T> hand::get_if() const
 {
-  auto p = boost::variant2::get_if<T>(&_v);
-  if (!p)
+  if (!holds_alternative<T>())
     return std::nullopt;
-  return *p;
+  return get<T>();
 }
 
 template <typename T>
-T const& hand::get() const
+T hand::get() const
 {
-  return boost::variant2::get<T>(_v);
+  if (!holds_alternative<T>())
+    throw boost::variant2::bad_variant_access{};
+  if constexpr (std::is_same_v<T, paired_hand>)
+    return to_paired_hand();
+  else
+    return to_unpaired_hand();
 }
 
 template <typename Callable>
 decltype(auto) hand::visit(Callable&& f) const
 {
-  return boost::variant2::visit(std::forward<Callable>(f), _v);
+  using result = decltype(f(std::declval<paired_hand const&>()));
+
+  if (index() == 0)
+  {
+    auto const ph = to_paired_hand();
+    return static_cast<result>(f(ph));
+  }
+  auto const uh = to_unpaired_hand();
+  return static_cast<result>(f(uh));
+}
 }
+
+namespace std
+{
+template <>
+struct hash<prc::hand>
+{
+  std::size_t operator()(prc::hand const& h) const noexcept
+  {
+    return h.id();
+  }
+};
 }
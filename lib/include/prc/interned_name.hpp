@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace prc
+{
+// Handle to a string stored once per process, so that copies, comparisons
+// and hashing are O(1). Interned strings are never freed: they are meant for
+// range and folder names, which are few distinct tokens repeated many times.
+//
+// Reading a name does not lock, interning does.
+class interned_name
+{
+public:
+  interned_name() = default;
+  explicit interned_name(std::string_view);
+
+  // does not intern str, nullopt if it never was
+  static std::optional<interned_name> find(std::string_view str);
+
+  std::string const& str() const;
+  std::uint32_t id() const;
+
+private:
+  explicit interned_name(std::uint32_t id);
+
+  // 0 is the empty string
+  std::uint32_t _id = 0;
+};
+
+bool operator==(interned_name lhs, interned_name rhs);
+bool operator!=(interned_name lhs, interned_name rhs);
+}
+
+namespace std
+{
+template <>
+struct hash<prc::interned_name>
+{
+  std::size_t operator()(prc::interned_name n) const noexcept
+  {
+    return n.id();
+  }
+};
+}
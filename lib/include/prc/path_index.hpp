@@ -0,0 +1,88 @@
+#pragma once
+
+#include <prc/folder.hpp>
+#include <prc/interned_name.hpp>
+#include <prc/range.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace prc
+{
+// folder or range designated by a path, ranges can be subranges
+struct path_entry
+{
+  folder const* f = nullptr;
+  range const* r = nullptr;
+
+  explicit operator bool() const
+  {
+    return f || r;
+  }
+};
+
+// Trie over the '/' separated paths of a folder's subfolders, ranges and
+// subranges, e.g. "/SB/vs_3bet/SB_2.5bb_BB_Call/Call". Children are looked
+// up in a single hash keyed by parent and interned component, so finding a
+// path costs O(path length) whatever the size of the folders.
+//
+// Nodes refer to entries by position, so the folder can be modified through
+// remove(). Any other change to the folder's structure or names requires
+// rebuilding the index. With duplicate names, the first entry is found.
+//
+// The folder is only read through its const accessors, so that indexing a
+// copy-on-write snapshot does not detach it; remove() only detaches the
+// ancestors of the removed entry.
+class path_index
+{
+public:
+  explicit path_index(folder& root);
+
+  path_entry find(std::string_view path) const;
+  // paths of the entries starting with prefix, and of their descendants, in
+  // tree order: "/SB/" lists everything in SB, "/SB/SB_2" only what starts
+  // with SB_2
+  std::vector<std::string> list(std::string_view prefix) const;
+  // removes the entry from the folder, false if there is none
+  bool remove(std::string_view path);
+
+private:
+  using index = std::uint32_t;
+
+  struct node
+  {
+    interned_name name;
+    index parent;
+    // in the parent's entries or subranges
+    index pos;
+    bool is_range;
+    std::vector<index> children;
+  };
+
+  // mutable folder or range, detaching the path leading to it
+  struct mutable_entry
+  {
+    folder* f = nullptr;
+    range* r = nullptr;
+  };
+
+  index add_node(index parent, interned_name, index pos, bool is_range);
+  void add_children(index, folder const&);
+  void add_children(index, range const&);
+  index find_node(std::string_view path) const;
+  index find_child(index parent, interned_name) const;
+  path_entry resolve(index) const;
+  mutable_entry resolve_mutable(index);
+  void list_subtree(index,
+                    std::string const& path,
+                    std::vector<std::string>& out) const;
+
+  folder& _root;
+  std::vector<node> _nodes;
+  // (parent << 32 | component id) -> first child with that name
+  std::unordered_map<std::uint64_t, index> _children;
+};
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace prc::pio
+{
+// Relative path (generic format) of each file of an exported pio library to
+// the hash of its content. It is kept in the library directory, so that the
+// next export only writes the files which changed.
+using manifest = std::map<std::string, std::uint64_t>;
+
+// empty when dst has no manifest yet
+manifest read_manifest(std::filesystem::path const& dst);
+void write_manifest(manifest const&, std::filesystem::path const& dst);
+std::filesystem::path manifest_path(std::filesystem::path const& dst);
+
+// Whether dst / filename already has this content hash: from old when it
+// lists the file, from the content on disk otherwise.
+bool is_unchanged(manifest const& old,
+                  std::string const& filename,
+                  std::uint64_t hash,
+                  std::filesystem::path const& dst);
+
+// Removes the files of old which are not part of current, and the
+// directories left empty. Files or directories which are already gone (e.g.
+// deleted by hand between two exports) are skipped. Returns the removed
+// files.
+std::vector<std::filesystem::path> remove_stale_files(
+    manifest const& old,
+    manifest const& current,
+    std::filesystem::path const& dst);
+}
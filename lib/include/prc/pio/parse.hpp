@@ -1,6 +1,7 @@
 #pragma once
 
 #include <filesystem>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -10,6 +11,17 @@
 
 namespace prc::pio
 {
+struct folder_visitor
+{
+  std::function<void(std::string const& name)> enter_folder;
+  std::function<void()> leave_folder;
+  std::function<void(range&&)> visit_range;
+};
+
 range parse_range(std::filesystem::path const& pio_range_path);
 folder parse_folder(std::filesystem::path const& pio_folder_path);
+// walks the directory in the same order as parse_folder, parsing ranges one at
+// a time instead of building the whole tree
+void walk_folder(std::filesystem::path const& pio_folder_path,
+                 folder_visitor const&);
 }
@@ -1,16 +1,20 @@
 #pragma once
 
+#include <prc/detail/arena.hpp>
+
 #include <string>
-#include <vector>
 
 #include <boost/fusion/include/io.hpp>
 
 namespace prc::pio::parser::ast
 {
+// Only live for the duration of parse_range, which runs in a scoped_arena.
+using weights = detail::arena_vector<double>;
+
 struct base_range
 {
   std::string name;
-  std::vector<double> weights;
+  ast::weights weights;
 };
 
 struct subrange
@@ -18,13 +22,13 @@ struct subrange
   bool included;
   int rgb;
   std::string name;
-  std::vector<double> weights;
+  ast::weights weights;
 };
 
 struct range
 {
   ast::base_range base_range;
-  std::vector<subrange> subranges;
+  detail::arena_vector<subrange> subranges;
 };
 
 using boost::fusion::operator<<;
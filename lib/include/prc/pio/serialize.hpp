@@ -3,10 +3,13 @@
 #include <string>
 #include <vector>
 
+#include <prc/detail/render_cache.hpp>
 #include <prc/range.hpp>
 
 namespace prc::pio
 {
 std::string serialize(prc::range const&);
+// reuses the weights of elems shared with previously serialized ranges
+std::string serialize(prc::range const&, detail::render_cache&);
 }
 
@@ -1,9 +1,15 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <iosfwd>
 #include <string>
+#include <utility>
 
 #include <prc/combo.hpp>
+#include <prc/detail/cached_hash.hpp>
+#include <prc/detail/cow.hpp>
+#include <prc/interned_name.hpp>
 #include <prc/range_elem.hpp>
 
 #include <prc/equilab/parser/ast.hpp>
@@ -17,7 +23,7 @@ public:
   struct weighted_elems
   {
     double weight;
-    std::vector<range_elem> elems;
+    range_elems elems;
   };
 
   range() = default;
@@ -31,27 +37,51 @@ public:
 
   void add_subrange(range const&);
   void add_subrange(range&&);
+  // constructs a range from args after the last subrange
+  template <typename... Args>
+  range& emplace_subrange(Args&&... args);
 
   range* find_subrange(std::string const& name);
   range const* find_subrange(std::string const& name) const;
+  range* find_subrange(interned_name name);
+  range const* find_subrange(interned_name name) const;
 
   void set_rgb(int);
   void set_name(std::string name);
   void set_elems(std::vector<weighted_elems> elems);
+  // uses the same elems as other, which must be equal, see deduplicate_elems
+  void share_elems_with(range const& other);
 
   std::string const& name() const;
+  interned_name name_handle() const;
   int rgb() const;
   std::vector<weighted_elems> const& elems() const;
+  // another range refers to the same elems()
+  bool shares_elems() const;
   std::vector<range> const& subranges() const;
   std::vector<range>& subranges();
 
+  // of the name, rgb, elems and subranges, computed once until the range is
+  // modified. References returned by non-const accessors must not be used to
+  // modify the range after hashing it, so operator== does not use it.
+  std::size_t hash() const;
+
 private:
-  std::string _name;
-  std::vector<weighted_elems> _elems;
-  std::vector<range> _subranges;
+  interned_name _name;
+  // shared between copies, subranges() clones them before modifying
+  detail::cow<std::vector<weighted_elems>> _elems;
+  detail::cow<std::vector<range>> _subranges;
   int _rgb;
+  detail::cached_hash _hash;
 };
 
+template <typename... Args>
+range& range::emplace_subrange(Args&&... args)
+{
+  _hash.reset();
+  return _subranges.mut().emplace_back(std::forward<Args>(args)...);
+}
+
 bool operator==(range const& lhs, range const& rhs);
 bool operator!=(range const& lhs, range const& rhs);
 
@@ -66,3 +96,15 @@ std::vector<range::weighted_elems> adjust_weights(
     std::vector<range::weighted_elems> const& base_range_elems, range const& r);
 std::ostream& operator<<(std::ostream&, range::weighted_elems const&);
 }
+
+namespace std
+{
+template <>
+struct hash<prc::range>
+{
+  std::size_t operator()(prc::range const& r) const
+  {
+    return r.hash();
+  }
+};
+}
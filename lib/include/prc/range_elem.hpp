@@ -7,12 +7,21 @@
 
 #include <boost/variant2/variant.hpp>
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iosfwd>
 #include <optional>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 namespace prc
 {
+// Combo, hand or hand range packed in 16 bits. The encoding preserves the
+// ordering of the unpacked values, alternatives are then ordered by index
+// (combo, hand, hand range) as in a variant. Accessors return unpacked
+// values, not references.
 class range_elem
 {
 public:
@@ -29,9 +38,11 @@ public:
   std::optional<T> get_if() const;
 
   int index() const;
+  // packed value, ordered as elems are
+  std::uint16_t id() const;
 
   template <typename T>
-  T const& get() const;
+  T get() const;
 
   template <typename Callable>
   decltype(auto) visit(Callable&&) const;
@@ -42,37 +53,85 @@ public:
   friend bool operator<(range_elem const& lhs, range_elem const& rhs);
 
 private:
-  boost::variant2::variant<combo, hand, hand_range> _v;
+  template <typename T>
+  static constexpr int index_of();
+
+  combo to_combo() const;
+  hand to_hand() const;
+  hand_range to_hand_range() const;
+
+  // 0b00 + 14 bits combo id, 0b01 + 14 bits hand id, 0b1 + 15 bits from id *
+  // 169 + to id
+  std::uint16_t _bits = 0;
 };
 
 bool operator!=(range_elem const& lhs, range_elem const& rhs);
 std::ostream& operator<<(std::ostream&, range_elem const&);
 
+template <typename T>
+constexpr int range_elem::index_of()
+{
+  if constexpr (std::is_same_v<T, combo>)
+    return 0;
+  else if constexpr (std::is_same_v<T, hand>)
+    return 1;
+  else
+  {
+    static_assert(std::is_same_v<T, hand_range>);
+    return 2;
+  }
+}
+
 template <typename T>
 bool range_elem::holds_alternative() const
 {
-  return boost::variant2::holds_alternative<T>(_v);
+  return index() == index_of<T>();
 }
 
 template <typename T>
 std::optional<T> range_elem::get_if() const
 {
-  auto p = boost::variant2::get_if<T>(&_v);
-  if (!p)
+  if (!holds_alternative<T>())
     return std::nullopt;
-  return *p;
+  return get<T>();
 }
 
 template <typename T>
-T const& range_elem::get() const
+T range_elem::get() const
 {
-  return boost::variant2::get<T>(_v);
+  if (!holds_alternative<T>())
+    throw boost::variant2::bad_variant_access{};
+  if constexpr (std::is_same_v<T, combo>)
+    return to_combo();
+  else if constexpr (std::is_same_v<T, hand>)
+    return to_hand();
+  else
+    return to_hand_range();
 }
 
 template <typename Callable>
 decltype(auto) range_elem::visit(Callable&& f) const
 {
-  return boost::variant2::visit(std::forward<Callable>(f), _v);
+  using result = decltype(f(std::declval<combo const&>()));
+
+  switch (index())
+  {
+  case 0:
+  {
+    auto const c = to_combo();
+    return static_cast<result>(f(c));
+  }
+  case 1:
+  {
+    auto const h = to_hand();
+    return static_cast<result>(f(h));
+  }
+  default:
+  {
+    auto const hr = to_hand_range();
+    return static_cast<result>(f(hr));
+  }
+  }
 }
 
 inline namespace literals
@@ -80,3 +139,15 @@ inline namespace literals
 range_elem operator"" _re(char const*, std::size_t);
 }
 }
+
+namespace std
+{
+template <>
+struct hash<prc::range_elem>
+{
+  std::size_t operator()(prc::range_elem const& e) const noexcept
+  {
+    return e.id();
+  }
+};
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <prc/folder.hpp>
+#include <prc/interned_name.hpp>
+#include <prc/range.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace prc
+{
+struct flattened_range
+{
+  std::filesystem::path fullpath;
+  prc::folder* parent_folder;
+  prc::range* range;
+};
+
+// every range of f and its subfolders (subranges excluded), in tree order
+std::vector<flattened_range> flatten_ranges(
+    folder& f, std::filesystem::path const& current_path);
+
+// Indexes a list of flattened ranges by name, to look up ranges without
+// scanning the whole list. The list must not be modified once indexed.
+class range_index
+{
+public:
+  range_index() = default;
+  explicit range_index(std::vector<flattened_range> ranges);
+
+  std::vector<flattened_range> const& ranges() const;
+
+  // positions in ranges() of the ranges with that name, in increasing order
+  std::vector<std::size_t> const& find(std::string const& name) const;
+  std::vector<std::size_t> const& find(interned_name name) const;
+  // position of the last range with that name which comes before pos
+  std::optional<std::size_t> find_before(std::string const& name,
+                                         std::size_t pos) const;
+  std::optional<std::size_t> find_before(interned_name name,
+                                         std::size_t pos) const;
+
+private:
+  std::vector<flattened_range> _ranges;
+  std::unordered_map<interned_name, std::vector<std::size_t>> _positions;
+};
+}
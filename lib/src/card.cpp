@@ -1,11 +1,11 @@
 #include <prc/card.hpp>
 #include <prc/parser/api.hpp>
 
-#include <tuple>
-
 namespace prc
 {
-card::card(prc::rank r, prc::suit s) : _r(r), _s(s)
+card::card(prc::rank r, prc::suit s)
+  : _id(static_cast<std::uint8_t>(static_cast<int>(r) * 4 +
+                                  static_cast<int>(s)))
 {
 }
 
@@ -13,27 +13,36 @@ card::card(parser::ast::card c) : card(c.rank, c.suit)
 {
 }
 
-prc::rank const& card::rank() const
+card card::from_id(std::uint8_t id)
+{
+  card c;
+  c._id = id;
+  return c;
+}
+
+prc::rank card::rank() const
+{
+  return static_cast<prc::rank>(_id / 4);
+}
+
+prc::suit card::suit() const
 {
-  return _r;
+  return static_cast<prc::suit>(_id % 4);
 }
 
-prc::suit const& card::suit() const
+std::uint8_t card::id() const
 {
-  return _s;
+  return _id;
 }
 
 std::string card::string() const
 {
-  std::string res;
-  res += rank_str[static_cast<int>(_r)];
-  res += suit_str[static_cast<int>(_s)];
-  return res;
+  return {rank_str[_id / 4], suit_str[_id % 4]};
 }
 
 bool operator==(card const& lhs, card const& rhs) noexcept
 {
-  return std::tie(lhs.rank(), lhs.suit()) == std::tie(rhs.rank(), rhs.suit());
+  return lhs.id() == rhs.id();
 }
 
 bool operator!=(card const& lhs, card const& rhs) noexcept
@@ -43,7 +52,7 @@ bool operator!=(card const& lhs, card const& rhs) noexcept
 
 bool operator<(card const& lhs, card const& rhs) noexcept
 {
-  return std::tie(lhs.rank(), lhs.suit()) < std::tie(rhs.rank(), rhs.suit());
+  return lhs.id() < rhs.id();
 }
 
 std::ostream& operator<<(std::ostream& os, card const& c)
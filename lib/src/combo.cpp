@@ -1,14 +1,15 @@
 #include <prc/combo.hpp>
 
+#include <prc/detail/profile.hpp>
 #include <prc/detail/unicode.hpp>
 #include <prc/hand.hpp>
 #include <prc/parser/api.hpp>
 #include <prc/range_elem.hpp>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <iostream>
-#include <map>
 #include <set>
 #include <stdexcept>
 #include <tuple>
@@ -17,6 +18,27 @@ namespace prc
 {
 namespace
 {
+detail::profile_timer reduce_combos_timer{"reduce_combos"};
+detail::profile_counter expanded_combos{"combos expanded"};
+
+struct combo_card_ids
+{
+  std::uint8_t high;
+  std::uint8_t low;
+};
+
+// cards of each combo id
+constexpr auto combo_cards = [] {
+  std::array<combo_card_ids, 1326> ret{};
+  std::size_t i = 0;
+  for (std::uint8_t high = 1; high < 52; ++high)
+  {
+    for (std::uint8_t low = 0; low < high; ++low)
+      ret[i++] = {high, low};
+  }
+  return ret;
+}();
+
 class hand_range_expander
 {
 public:
@@ -107,10 +129,11 @@ private:
   std::back_insert_iterator<std::vector<hand>> mutable _out;
 };
 
+template <typename OutputIterator>
 class combo_expander
 {
 public:
-  combo_expander(std::back_insert_iterator<std::vector<combo>> out) : _out{out}
+  combo_expander(OutputIterator out) : _out{out}
   {
   }
 
@@ -125,8 +148,8 @@ public:
     {
       for (auto j = i + 1; j < 4; ++j)
       {
-        *_out = {card{h.rank(), static_cast<suit>(i)},
-                 card{h.rank(), static_cast<suit>(j)}};
+        *_out = combo::from_ordered(card{h.rank(), static_cast<suit>(j)},
+                                    card{h.rank(), static_cast<suit>(i)});
       }
     }
   }
@@ -137,8 +160,8 @@ public:
     {
       for (auto i = 0; i < 4; ++i)
       {
-        *_out = {card{uh.high(), static_cast<suit>(i)},
-                 card{uh.low(), static_cast<suit>(i)}};
+        *_out = combo::from_ordered(card{uh.high(), static_cast<suit>(i)},
+                                    card{uh.low(), static_cast<suit>(i)});
       }
     }
     else
@@ -149,8 +172,8 @@ public:
         {
           if (i == j)
             continue;
-          *_out = {card{uh.high(), static_cast<suit>(i)},
-                   card{uh.low(), static_cast<suit>(j)}};
+          *_out = combo::from_ordered(card{uh.high(), static_cast<suit>(i)},
+                                      card{uh.low(), static_cast<suit>(j)});
         }
       }
     }
@@ -170,7 +193,29 @@ public:
   }
 
 private:
-  std::back_insert_iterator<std::vector<combo>> mutable _out;
+  OutputIterator mutable _out;
+};
+
+class combo_set_inserter
+{
+public:
+  explicit combo_set_inserter(combo_set& s) : _set{&s}
+  {
+  }
+
+  combo_set_inserter& operator*()
+  {
+    return *this;
+  }
+
+  combo_set_inserter& operator=(combo const& c)
+  {
+    _set->insert(c);
+    return *this;
+  }
+
+private:
+  combo_set* _set;
 };
 
 struct paired_hands_pred
@@ -234,7 +279,7 @@ struct hand_range_validator
 template <typename BinaryPredicate, typename Iterator, typename Sentinel>
 void reduce_hand_ranges(Iterator it,
                         Sentinel const s,
-                        std::vector<range_elem>& out)
+                        range_elems& out)
 {
   while (it != s)
   {
@@ -263,19 +308,22 @@ void reduce_hand_ranges(Iterator it,
 }
 
 template <typename Iterator, typename Sentinel>
-std::vector<range_elem> reduce_pairs(Iterator it, Sentinel s)
+range_elems reduce_pairs(Iterator it, Sentinel s)
 {
-  std::vector<range_elem> ret;
-  std::map<rank, std::vector<combo>> combos_by_rank;
+  range_elems ret;
+  // indexed by rank
+  std::array<std::vector<combo>, 13> combos_by_rank;
 
-  std::for_each(
-      it, s, [&](auto& e) { combos_by_rank[e.high().rank()].push_back(e); });
+  std::for_each(it, s, [&](auto& e) {
+    combos_by_rank[static_cast<int>(e.high().rank())].push_back(e);
+  });
 
   std::vector<paired_hand> pairs;
-  for (auto const& [r, combos] : combos_by_rank)
+  for (auto r = 0; r < 13; ++r)
   {
+    auto const& combos = combos_by_rank[r];
     if (combos.size() == 6)
-      pairs.emplace_back(r);
+      pairs.emplace_back(static_cast<rank>(r));
     else
     {
       std::transform(
@@ -289,23 +337,35 @@ std::vector<range_elem> reduce_pairs(Iterator it, Sentinel s)
   return ret;
 }
 
+// indexed by high rank * 13 + low rank
 template <typename Iterator, typename Sentinel>
-std::vector<range_elem> reduce_suited(Iterator it, Sentinel s)
+std::array<std::vector<combo>, 13 * 13> group_by_ranks(Iterator it, Sentinel s)
 {
-  std::vector<range_elem> ret;
-  std::map<std::pair<rank, rank>, std::vector<combo>> combos_by_ranks;
-
+  std::array<std::vector<combo>, 13 * 13> ret;
   std::for_each(it, s, [&](auto& e) {
-    combos_by_ranks[std::make_pair(e.high().rank(), e.low().rank())].push_back(
-        e);
+    auto const high = static_cast<int>(e.high().rank());
+    auto const low = static_cast<int>(e.low().rank());
+    ret[high * 13 + low].push_back(e);
   });
+  return ret;
+}
+
+template <typename Iterator, typename Sentinel>
+range_elems reduce_suited(Iterator it, Sentinel s)
+{
+  range_elems ret;
+  auto const combos_by_ranks = group_by_ranks(it, s);
 
   std::vector<unpaired_hand> unpaired_hands;
-  for (auto const& [ranks, combos] : combos_by_ranks)
+  for (auto i = 0; i < 13 * 13; ++i)
   {
-    auto const [high, low] = ranks;
+    auto const& combos = combos_by_ranks[i];
     if (combos.size() == 4)
-      unpaired_hands.emplace_back(high, low, suitedness::suited);
+    {
+      unpaired_hands.emplace_back(static_cast<rank>(i / 13),
+                                  static_cast<rank>(i % 13),
+                                  suitedness::suited);
+    }
     else
     {
       std::transform(
@@ -321,22 +381,21 @@ std::vector<range_elem> reduce_suited(Iterator it, Sentinel s)
 }
 
 template <typename Iterator, typename Sentinel>
-std::vector<range_elem> reduce_offsuit(Iterator it, Sentinel s)
+range_elems reduce_offsuit(Iterator it, Sentinel s)
 {
-  std::vector<range_elem> ret;
-  std::map<std::pair<rank, rank>, std::vector<combo>> combos_by_ranks;
-
-  std::for_each(it, s, [&](auto& e) {
-    combos_by_ranks[std::make_pair(e.high().rank(), e.low().rank())].push_back(
-        e);
-  });
+  range_elems ret;
+  auto const combos_by_ranks = group_by_ranks(it, s);
 
   std::vector<unpaired_hand> unpaired_hands;
-  for (auto const& [ranks, combos] : combos_by_ranks)
+  for (auto i = 0; i < 13 * 13; ++i)
   {
-    auto const [high, low] = ranks;
+    auto const& combos = combos_by_ranks[i];
     if (combos.size() == 12)
-      unpaired_hands.emplace_back(high, low, suitedness::offsuit);
+    {
+      unpaired_hands.emplace_back(static_cast<rank>(i / 13),
+                                  static_cast<rank>(i % 13),
+                                  suitedness::offsuit);
+    }
     else
     {
       std::transform(
@@ -376,9 +435,27 @@ std::vector<T> sort_unique(std::vector<T> const& v)
   ret.erase(it, ret.end());
   return ret;
 }
+
+// vec must be sorted with comp, without duplicates
+range_elems reduce_sorted_combos(std::vector<combo> vec)
+{
+  auto const pairs_it = std::stable_partition(
+      vec.begin(), vec.end(), [](auto& e) { return e.paired(); });
+  auto const suited_it = std::stable_partition(
+      pairs_it, vec.end(), [](auto& e) { return e.suited(); });
+
+  auto ret = reduce_pairs(vec.begin(), pairs_it);
+  auto suited = reduce_suited(pairs_it, suited_it);
+  auto offsuit = reduce_offsuit(suited_it, vec.end());
+
+  ret.insert(ret.end(), suited.begin(), suited.end());
+  ret.insert(ret.end(), offsuit.begin(), offsuit.end());
+  std::sort(ret.begin(), ret.end());
+  return ret;
+}
 }
 
-combo::combo(card lhs, card rhs) : _high(lhs), _low(rhs)
+combo::combo(card lhs, card rhs)
 {
   if (lhs == rhs)
   {
@@ -386,7 +463,8 @@ combo::combo(card lhs, card rhs) : _high(lhs), _low(rhs)
         "combo cannot be composed of two exact same cards"};
   }
   if (lhs < rhs)
-    std::swap(_high, _low);
+    std::swap(lhs, rhs);
+  *this = from_ordered(lhs, rhs);
 }
 
 combo::combo(parser::ast::combo const& c)
@@ -394,24 +472,42 @@ combo::combo(parser::ast::combo const& c)
 {
 }
 
-card const& combo::high() const
+combo combo::from_id(std::uint16_t id)
+{
+  combo c;
+  c._id = id;
+  return c;
+}
+
+combo combo::from_ordered(card high, card low)
 {
-  return _high;
+  auto const h = high.id();
+  return from_id(static_cast<std::uint16_t>(h * (h - 1) / 2 + low.id()));
 }
 
-card const& combo::low() const
+card combo::high() const
 {
-  return _low;
+  return card::from_id(combo_cards[_id].high);
+}
+
+card combo::low() const
+{
+  return card::from_id(combo_cards[_id].low);
+}
+
+std::uint16_t combo::id() const
+{
+  return _id;
 }
 
 std::string combo::string() const
 {
-  return _high.string() + _low.string();
+  return high().string() + low().string();
 }
 
 bool combo::suited() const
 {
-  return _high.suit() == _low.suit();
+  return high().suit() == low().suit();
 }
 
 bool combo::offsuit() const
@@ -421,12 +517,12 @@ bool combo::offsuit() const
 
 bool combo::paired() const
 {
-  return _high.rank() == _low.rank();
+  return high().rank() == low().rank();
 }
 
 bool operator==(combo const& lhs, combo const& rhs) noexcept
 {
-  return std::tie(lhs.high(), lhs.low()) == std::tie(rhs.high(), rhs.low());
+  return lhs.id() == rhs.id();
 }
 
 bool operator!=(combo const& lhs, combo const& rhs) noexcept
@@ -436,7 +532,7 @@ bool operator!=(combo const& lhs, combo const& rhs) noexcept
 
 bool operator<(combo const& lhs, combo const& rhs) noexcept
 {
-  return std::tie(lhs.high(), lhs.low()) < std::tie(rhs.high(), rhs.low());
+  return lhs.id() < rhs.id();
 }
 
 std::ostream& operator<<(std::ostream& os, combo const& c)
@@ -449,10 +545,11 @@ std::vector<prc::combo> expand_combos(range_elem const& elem)
   std::vector<prc::combo> ret;
   elem.visit(combo_expander{std::back_inserter(ret)});
   std::sort(ret.begin(), ret.end());
+  expanded_combos.add(ret.size());
   return ret;
 }
 
-std::vector<prc::combo> expand_combos(std::vector<range_elem> const& elems)
+std::vector<prc::combo> expand_combos(range_elems const& elems)
 {
   std::vector<prc::combo> ret;
   combo_expander exp{std::back_inserter(ret)};
@@ -460,10 +557,11 @@ std::vector<prc::combo> expand_combos(std::vector<range_elem> const& elems)
     elem.visit(exp);
   std::sort(ret.begin(), ret.end());
   ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+  expanded_combos.add(ret.size());
   return ret;
 }
 
-std::vector<prc::hand> expand_hands(std::vector<range_elem> const& elems)
+std::vector<prc::hand> expand_hands(range_elems const& elems)
 {
   std::vector<prc::hand> ret;
   hand_expander exp{std::back_inserter(ret)};
@@ -474,29 +572,93 @@ std::vector<prc::hand> expand_hands(std::vector<range_elem> const& elems)
   return ret;
 }
 
-std::vector<range_elem> reduce_combos(std::vector<combo> const& combos)
+range_elems reduce_combos(std::vector<combo> const& combos)
 {
-  auto vec = sort_unique(combos);
+  detail::scoped_timer const timer{reduce_combos_timer};
+  return reduce_sorted_combos(sort_unique(combos));
+}
 
-  auto const pairs_it = std::stable_partition(
-      vec.begin(), vec.end(), [](auto& e) { return e.paired(); });
-  auto const suited_it = std::stable_partition(
-      pairs_it, vec.end(), [](auto& e) { return e.suited(); });
+range_elems reduce_combos(combo_set const& combos)
+{
+  detail::scoped_timer const timer{reduce_combos_timer};
+  std::vector<combo> vec;
+  vec.reserve(combos.size());
+  // same order as sort_unique: ranks first, then suits
+  for (auto high_rank = 0; high_rank < 13; ++high_rank)
+  {
+    for (auto low_rank = 0; low_rank <= high_rank; ++low_rank)
+    {
+      for (auto high_suit = 0; high_suit < 4; ++high_suit)
+      {
+        for (auto low_suit = 0; low_suit < 4; ++low_suit)
+        {
+          if (high_rank == low_rank && low_suit >= high_suit)
+            continue;
+          combo const c{card{static_cast<rank>(high_rank),
+                             static_cast<suit>(high_suit)},
+                        card{static_cast<rank>(low_rank),
+                             static_cast<suit>(low_suit)}};
+          if (combos.contains(c))
+            vec.push_back(c);
+        }
+      }
+    }
+  }
+  return reduce_sorted_combos(std::move(vec));
+}
 
-  auto ret = reduce_pairs(vec.begin(), pairs_it);
-  auto suited = reduce_suited(pairs_it, suited_it);
-  auto offsuit = reduce_offsuit(suited_it, vec.end());
+combo_set::combo_set(range_elems const& elems)
+{
+  insert(elems);
+}
 
-  ret.insert(ret.end(), suited.begin(), suited.end());
-  ret.insert(ret.end(), offsuit.begin(), offsuit.end());
-  std::sort(ret.begin(), ret.end());
-  return ret;
+void combo_set::insert(combo const& c)
+{
+  _combos.set(combo_index(c));
+}
+
+void combo_set::insert(range_elem const& elem)
+{
+  elem.visit(combo_expander{combo_set_inserter{*this}});
+}
+
+void combo_set::insert(range_elems const& elems)
+{
+  combo_expander exp{combo_set_inserter{*this}};
+  for (auto const& elem : elems)
+    elem.visit(exp);
+}
+
+combo_set& combo_set::operator|=(combo_set const& other)
+{
+  _combos |= other._combos;
+  return *this;
+}
+
+bool combo_set::contains(combo const& c) const
+{
+  return _combos.test(combo_index(c));
+}
+
+std::size_t combo_set::size() const
+{
+  return _combos.count();
+}
+
+bool combo_set::empty() const
+{
+  return _combos.none();
+}
+
+std::size_t combo_index(combo const& c)
+{
+  return c.id();
 }
 
-std::vector<range_elem> const& any_two()
+range_elems const& any_two()
 {
-  static std::vector const vec = [] {
-    std::vector v{"22+"_re,  "A2o+"_re, "K2o+"_re, "Q2o+"_re, "J2o+"_re,
+  static range_elems const vec = [] {
+    range_elems v{"22+"_re,  "A2o+"_re, "K2o+"_re, "Q2o+"_re, "J2o+"_re,
                   "T2o+"_re, "92o+"_re, "82o+"_re, "72o+"_re, "62o+"_re,
                   "52o+"_re, "42o+"_re, "32o"_re,  "A2s+"_re, "K2s+"_re,
                   "Q2s+"_re, "J2s+"_re, "T2s+"_re, "92s+"_re, "82s+"_re,
@@ -0,0 +1,88 @@
+#include <prc/deduplicate.hpp>
+
+#include <prc/detail/hash.hpp>
+#include <prc/detail/profile.hpp>
+
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace prc
+{
+namespace
+{
+detail::profile_timer deduplicate_timer{"deduplicate_elems"};
+
+std::uint64_t hash_elems(std::vector<range::weighted_elems> const& elems)
+{
+  auto h = detail::fnv1a_offset_basis;
+  for (auto const& [weight, group] : elems)
+  {
+    char bytes[sizeof(weight)];
+    std::memcpy(bytes, &weight, sizeof(weight));
+    h = detail::fnv1a({bytes, sizeof(bytes)}, h);
+    for (auto const& e : group)
+    {
+      h = detail::fnv1a(e.string(), h);
+      h = detail::fnv1a(",", h);
+    }
+  }
+  return h;
+}
+
+class deduplicator
+{
+public:
+  void operator()(folder& f)
+  {
+    for (auto& e : f.entries())
+      boost::variant2::visit(*this, e);
+  }
+
+  void operator()(range& r)
+  {
+    deduplicate(r);
+    for (auto& sub : r.subranges())
+      (*this)(sub);
+  }
+
+  std::size_t nb_shared() const
+  {
+    return _nb_shared;
+  }
+
+private:
+  void deduplicate(range& r)
+  {
+    if (r.elems().empty())
+      return;
+    auto& candidates = _by_hash[hash_elems(r.elems())];
+    for (auto const c : candidates)
+    {
+      if (&c->elems() == &r.elems())
+        return;
+      if (c->elems() == r.elems())
+      {
+        r.share_elems_with(*c);
+        ++_nb_shared;
+        return;
+      }
+    }
+    candidates.push_back(&r);
+  }
+
+  // first ranges with given elems, pointers stay valid as folders and
+  // ranges are detached before their children are visited
+  std::unordered_map<std::uint64_t, std::vector<range const*>> _by_hash;
+  std::size_t _nb_shared = 0;
+};
+}
+
+std::size_t deduplicate_elems(folder& root)
+{
+  detail::scoped_timer const timer{deduplicate_timer};
+  deduplicator d;
+  d(root);
+  return d.nb_shared();
+}
+}
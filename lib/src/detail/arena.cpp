@@ -0,0 +1,62 @@
+#include <prc/detail/arena.hpp>
+
+#include <memory>
+
+namespace prc::detail
+{
+namespace
+{
+// large enough for a pio range with a dozen subranges
+constexpr std::size_t thread_buffer_size = 1 << 20;
+
+struct thread_arena
+{
+  std::pmr::memory_resource* current = nullptr;
+  std::unique_ptr<std::byte[]> buffer;
+  bool buffer_in_use = false;
+};
+
+thread_local thread_arena arena;
+
+bool acquire_thread_buffer()
+{
+  if (arena.buffer_in_use)
+    return false;
+  if (!arena.buffer)
+    arena.buffer = std::make_unique<std::byte[]>(thread_buffer_size);
+  arena.buffer_in_use = true;
+  return true;
+}
+
+std::pmr::monotonic_buffer_resource make_resource(bool thread_buffer)
+{
+  if (thread_buffer)
+  {
+    return std::pmr::monotonic_buffer_resource{arena.buffer.get(),
+                                               thread_buffer_size,
+                                               std::pmr::get_default_resource()};
+  }
+  return std::pmr::monotonic_buffer_resource{std::pmr::get_default_resource()};
+}
+}
+
+std::pmr::memory_resource* current_arena()
+{
+  return arena.current ? arena.current : std::pmr::get_default_resource();
+}
+
+scoped_arena::scoped_arena()
+  : _previous{arena.current},
+    _owns_thread_buffer{acquire_thread_buffer()},
+    _resource{make_resource(_owns_thread_buffer)}
+{
+  arena.current = &_resource;
+}
+
+scoped_arena::~scoped_arena()
+{
+  arena.current = _previous;
+  if (_owns_thread_buffer)
+    arena.buffer_in_use = false;
+}
+}
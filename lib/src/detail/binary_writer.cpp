@@ -0,0 +1,108 @@
+#include <prc/detail/binary_writer.hpp>
+
+#include <unicode/utf16.h>
+#include <unicode/utf8.h>
+
+#include <cstring>
+
+namespace prc::detail
+{
+namespace
+{
+template <typename T>
+void write_little_endian(std::string& buffer, T n)
+{
+  char bytes[sizeof(T)];
+  for (auto i = 0u; i < sizeof(T); ++i)
+    bytes[i] = static_cast<char>((n >> (8 * i)) & 0xFF);
+  buffer.append(bytes, sizeof(T));
+}
+
+template <typename Callable>
+void for_each_code_point(std::string_view utf8, Callable&& c)
+{
+  auto const s = reinterpret_cast<std::uint8_t const*>(utf8.data());
+  std::int32_t const length = utf8.size();
+  std::int32_t i = 0;
+  while (i < length)
+  {
+    UChar32 cp;
+    // ill-formed sequences are replaced by U+FFFD, like UnicodeString does
+    U8_NEXT_OR_FFFD(s, i, length, cp);
+    c(cp);
+  }
+}
+}
+
+binary_writer::binary_writer(std::size_t capacity)
+{
+  reserve(capacity);
+}
+
+void binary_writer::reserve(std::size_t capacity)
+{
+  _buffer.reserve(capacity);
+}
+
+void binary_writer::write_byte(std::uint8_t n)
+{
+  _buffer.push_back(static_cast<char>(n));
+}
+
+void binary_writer::write_word(std::uint16_t n)
+{
+  write_little_endian(_buffer, n);
+}
+
+void binary_writer::write_dword(std::int32_t n)
+{
+  write_little_endian(_buffer, static_cast<std::uint32_t>(n));
+}
+
+void binary_writer::write_double(double d)
+{
+  std::uint64_t n;
+  std::memcpy(&n, &d, sizeof(double));
+  write_little_endian(_buffer, n);
+}
+
+void binary_writer::write_bytes(std::string_view bytes)
+{
+  _buffer.append(bytes.data(), bytes.size());
+}
+
+void binary_writer::write_utf16le(std::string_view utf8)
+{
+  for_each_code_point(utf8, [this](UChar32 cp) {
+    if (U16_LENGTH(cp) == 1)
+      write_word(static_cast<std::uint16_t>(cp));
+    else
+    {
+      write_word(U16_LEAD(cp));
+      write_word(U16_TRAIL(cp));
+    }
+  });
+}
+
+std::size_t binary_writer::size() const
+{
+  return _buffer.size();
+}
+
+std::string const& binary_writer::buffer() const
+{
+  return _buffer;
+}
+
+std::string binary_writer::release()
+{
+  return std::move(_buffer);
+}
+
+std::size_t utf16_length(std::string_view utf8)
+{
+  std::size_t ret = 0;
+  for_each_code_point(utf8, [&ret](UChar32 cp) { ret += U16_LENGTH(cp); });
+  return ret;
+}
+}
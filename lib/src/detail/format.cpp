@@ -0,0 +1,46 @@
+#include <prc/detail/format.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+namespace prc::detail
+{
+namespace
+{
+char* trim_trailing_zeros(char* first, char* last, int min_decimals)
+{
+  auto const dot = std::find(first, last, '.');
+  if (dot == last)
+    return last;
+  auto const min_last = dot + 1 + min_decimals;
+  while (last > min_last && *(last - 1) == '0')
+    --last;
+  if (last == dot + 1)
+    --last;
+  return last;
+}
+}
+
+void append_double(std::string& out, double d, float_format const& fmt)
+{
+  char buf[128];
+  auto const first = std::begin(buf);
+  auto const last = std::end(buf);
+
+  auto res = std::to_chars(first, last, d, fmt.notation, fmt.precision);
+  // only happens with huge fixed values, which weights never are
+  if (res.ec != std::errc{})
+    res = std::to_chars(first, last, d);
+  auto end = res.ptr;
+  if (fmt.notation == std::chars_format::fixed)
+    end = trim_trailing_zeros(first, end, fmt.min_decimals);
+  out.append(first, end);
+}
+
+std::string format_double(double d, float_format const& fmt)
+{
+  std::string ret;
+  append_double(ret, d, fmt);
+  return ret;
+}
+}
@@ -0,0 +1,32 @@
+#include <prc/detail/hash.hpp>
+
+#include <charconv>
+
+namespace prc::detail
+{
+std::uint64_t fnv1a(std::string_view bytes, std::uint64_t seed)
+{
+  auto h = seed;
+  for (auto const c : bytes)
+  {
+    h ^= static_cast<std::uint8_t>(c);
+    h *= 0x100000001b3;
+  }
+  return h;
+}
+
+std::string to_hex(std::uint64_t n)
+{
+  std::string ret(16, '0');
+  for (auto i = 15; i >= 0; --i, n >>= 4)
+    ret[i] = "0123456789abcdef"[n & 0xF];
+  return ret;
+}
+
+bool from_hex(std::string_view s, std::uint64_t& n)
+{
+  auto const last = s.data() + s.size();
+  auto const [ptr, ec] = std::from_chars(s.data(), last, n, 16);
+  return ec == std::errc{} && ptr == last;
+}
+}
@@ -0,0 +1,35 @@
+#include <prc/detail/parallel.hpp>
+
+namespace prc::detail
+{
+std::vector<subtree_chunk> split_subtrees(folder const& root,
+                                          std::size_t min_chunks)
+{
+  std::vector<subtree_chunk> chunks;
+  for (auto const& entry : root.entries())
+    chunks.push_back({&entry, nullptr, 1});
+
+  auto has_folders = true;
+  while (chunks.size() < min_chunks && has_folders)
+  {
+    has_folders = false;
+    std::vector<subtree_chunk> next;
+    for (auto const& chunk : chunks)
+    {
+      auto const f =
+          chunk.entry ? boost::variant2::get_if<folder>(chunk.entry) : nullptr;
+      if (!f)
+      {
+        next.push_back(chunk);
+        continue;
+      }
+      has_folders = true;
+      next.push_back({nullptr, f, chunk.depth});
+      for (auto const& entry : f->entries())
+        next.push_back({&entry, nullptr, chunk.depth + 1});
+    }
+    chunks = std::move(next);
+  }
+  return chunks;
+}
+}
@@ -0,0 +1,193 @@
+#include <prc/detail/profile.hpp>
+
+#include <prc/detail/format.hpp>
+
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace prc::detail
+{
+namespace
+{
+struct trace_event
+{
+  profile_timer const* timer;
+  profile_timer::clock::time_point start;
+  profile_timer::clock::duration duration;
+};
+
+// written by its thread only, the mutex is uncontended until written out
+struct thread_events
+{
+  std::size_t tid;
+  std::mutex mutex;
+  std::vector<trace_event> events;
+};
+
+struct registry
+{
+  std::mutex mutex;
+  std::vector<profile_counter const*> counters;
+  std::vector<profile_timer const*> timers;
+  // outlive their threads, so that they can be written at the end
+  std::vector<std::unique_ptr<thread_events>> threads;
+  profile_timer::clock::time_point epoch = profile_timer::clock::now();
+};
+
+registry& get_registry()
+{
+  static registry r;
+  return r;
+}
+
+thread_events& local_events()
+{
+  thread_local thread_events* events = [] {
+    auto& r = get_registry();
+    std::lock_guard lock{r.mutex};
+    auto const tid = r.threads.size();
+    return r.threads.emplace_back(new thread_events{tid, {}, {}}).get();
+  }();
+  return *events;
+}
+
+void write_json_string(std::ostream& os, std::string const& str)
+{
+  os << '"';
+  for (auto const c : str)
+  {
+    if (c == '"' || c == '\\')
+      os << '\\';
+    os << c;
+  }
+  os << '"';
+}
+
+constexpr float_format duration_format{std::chars_format::fixed, 3};
+
+// e.g. format_duration<std::milli> for milliseconds
+template <typename Period>
+std::string format_duration(profile_timer::clock::duration d)
+{
+  return format_double(std::chrono::duration<double, Period>{d}.count(),
+                       duration_format);
+}
+}
+
+void set_profile_mode(profile_mode mode)
+{
+  get_registry().epoch = profile_timer::clock::now();
+  active_profile_mode.store(mode, std::memory_order_relaxed);
+}
+
+profile_counter::profile_counter(std::string name) : _name{std::move(name)}
+{
+  auto& r = get_registry();
+  std::lock_guard lock{r.mutex};
+  r.counters.push_back(this);
+}
+
+std::size_t profile_counter::value() const
+{
+  return _value.load(std::memory_order_relaxed);
+}
+
+std::string const& profile_counter::name() const
+{
+  return _name;
+}
+
+profile_timer::profile_timer(std::string name) : _name{std::move(name)}
+{
+  auto& r = get_registry();
+  std::lock_guard lock{r.mutex};
+  r.timers.push_back(this);
+}
+
+void profile_timer::record(clock::time_point start, clock::time_point end)
+{
+  _count.fetch_add(1, std::memory_order_relaxed);
+  _total_ns.fetch_add(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+          .count(),
+      std::memory_order_relaxed);
+  if (active_profile_mode.load(std::memory_order_relaxed) ==
+      profile_mode::trace)
+  {
+    auto& events = local_events();
+    std::lock_guard lock{events.mutex};
+    events.events.push_back({this, start, end - start});
+  }
+}
+
+std::size_t profile_timer::count() const
+{
+  return _count.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds profile_timer::total() const
+{
+  return std::chrono::nanoseconds{_total_ns.load(std::memory_order_relaxed)};
+}
+
+std::string const& profile_timer::name() const
+{
+  return _name;
+}
+
+void write_profile(std::ostream& os)
+{
+  auto& r = get_registry();
+  std::lock_guard lock{r.mutex};
+  auto first = true;
+  os << "{\n  \"timers\": {";
+  for (auto const timer : r.timers)
+  {
+    if (timer->count() == 0)
+      continue;
+    os << (first ? "\n    " : ",\n    ");
+    first = false;
+    write_json_string(os, timer->name());
+    os << ": {\"count\": " << timer->count() << ", \"total_ms\": "
+       << format_duration<std::milli>(timer->total()) << '}';
+  }
+  first = true;
+  os << "\n  },\n  \"counters\": {";
+  for (auto const counter : r.counters)
+  {
+    if (counter->value() == 0)
+      continue;
+    os << (first ? "\n    " : ",\n    ");
+    first = false;
+    write_json_string(os, counter->name());
+    os << ": " << counter->value();
+  }
+  os << "\n  }\n}\n";
+}
+
+void write_trace(std::ostream& os)
+{
+  auto& r = get_registry();
+  std::lock_guard lock{r.mutex};
+  auto first = true;
+  os << "{\"traceEvents\": [";
+  for (auto const& thread : r.threads)
+  {
+    std::lock_guard thread_lock{thread->mutex};
+    for (auto const& e : thread->events)
+    {
+      os << (first ? "\n" : ",\n");
+      first = false;
+      os << "{\"name\": ";
+      write_json_string(os, e.timer->name());
+      os << ", \"ph\": \"X\", \"ts\": "
+         << format_duration<std::micro>(e.start - r.epoch)
+         << ", \"dur\": " << format_duration<std::micro>(e.duration)
+         << ", \"pid\": 1, \"tid\": " << thread->tid << '}';
+    }
+  }
+  os << "\n]}\n";
+}
+}
@@ -0,0 +1,16 @@
+#include <prc/detail/render_cache.hpp>
+
+#include <prc/detail/profile.hpp>
+
+namespace prc::detail
+{
+namespace
+{
+profile_counter reused_elems{"reused rendered elems"};
+}
+
+void render_cache::record_reuse()
+{
+  reused_elems.add();
+}
+}
@@ -0,0 +1,140 @@
+#include <prc/detail/thread_pool.hpp>
+
+#include <optional>
+#include <utility>
+
+namespace prc::detail
+{
+namespace
+{
+struct worker_info
+{
+  thread_pool const* pool;
+  std::size_t queue_index;
+};
+
+thread_local worker_info current_worker{nullptr, 0};
+}
+
+thread_pool::thread_pool(std::size_t nb_workers)
+{
+  for (std::size_t i = 0; i <= nb_workers; ++i)
+    _queues.push_back(std::make_unique<queue>());
+  for (std::size_t i = 0; i < nb_workers; ++i)
+    _workers.emplace_back([this, i] { work(i); });
+}
+
+thread_pool::~thread_pool()
+{
+  {
+    std::lock_guard lock{_sleep_mutex};
+    _stop = true;
+  }
+  _wake_up.notify_all();
+  for (auto& w : _workers)
+    w.join();
+}
+
+std::size_t thread_pool::nb_workers() const
+{
+  return _workers.size();
+}
+
+void thread_pool::submit(task_group& group, std::function<void()> func)
+{
+  ++group._pending;
+  auto& q = *_queues[current_queue()];
+  {
+    std::lock_guard lock{q.mutex};
+    q.tasks.push_back({std::move(func), &group});
+  }
+  {
+    std::lock_guard lock{_sleep_mutex};
+    ++_nb_queued;
+  }
+  _wake_up.notify_one();
+}
+
+void thread_pool::wait(task_group& group)
+{
+  auto const queue_index = current_queue();
+  while (group._pending > 0 && try_run_one(queue_index))
+  {
+  }
+  // the remaining tasks of the group are running on other threads
+  std::unique_lock lock{group._mutex};
+  group._done.wait(lock, [&] { return group._pending == 0; });
+  if (auto error = std::exchange(group._error, nullptr))
+    std::rethrow_exception(error);
+}
+
+std::size_t thread_pool::current_queue() const
+{
+  if (current_worker.pool == this)
+    return current_worker.queue_index;
+  return _queues.size() - 1;
+}
+
+bool thread_pool::try_run_one(std::size_t queue_index)
+{
+  std::optional<task> t;
+  for (std::size_t i = 0; i < _queues.size() && !t; ++i)
+  {
+    auto const index = (queue_index + i) % _queues.size();
+    auto& q = *_queues[index];
+    std::lock_guard lock{q.mutex};
+    if (q.tasks.empty())
+      continue;
+    if (index == queue_index)
+    {
+      t = std::move(q.tasks.back());
+      q.tasks.pop_back();
+    }
+    else
+    {
+      t = std::move(q.tasks.front());
+      q.tasks.pop_front();
+    }
+  }
+  if (!t)
+    return false;
+  {
+    std::lock_guard lock{_sleep_mutex};
+    --_nb_queued;
+  }
+
+  try
+  {
+    t->func();
+  }
+  catch (...)
+  {
+    std::lock_guard lock{t->group->_mutex};
+    if (!t->group->_error)
+      t->group->_error = std::current_exception();
+  }
+  finish(*t->group);
+  return true;
+}
+
+void thread_pool::finish(task_group& group)
+{
+  std::lock_guard lock{group._mutex};
+  if (--group._pending == 0)
+    group._done.notify_all();
+}
+
+void thread_pool::work(std::size_t queue_index)
+{
+  current_worker = {this, queue_index};
+  while (true)
+  {
+    if (try_run_one(queue_index))
+      continue;
+    std::unique_lock lock{_sleep_mutex};
+    _wake_up.wait(lock, [this] { return _stop || _nb_queued > 0; });
+    if (_stop)
+      return;
+  }
+}
+}
@@ -1,5 +1,7 @@
 #include <prc/equilab/parse.hpp>
 
+#include <prc/detail/arena.hpp>
+#include <prc/detail/profile.hpp>
 #include <prc/detail/unicode.hpp>
 #include <prc/equilab/parser/api.hpp>
 
@@ -10,8 +12,14 @@ namespace fs = std::filesystem;
 
 namespace prc::equilab
 {
+namespace
+{
+detail::profile_timer parse_timer{"equilab::parse"};
+}
+
 folder parse(fs::path const& src_file)
 {
+  detail::scoped_timer const timer{parse_timer};
   namespace x3 = boost::spirit::x3;
 
   std::ifstream ifs{src_file.string(), std::ios::binary};
@@ -25,6 +33,8 @@ folder parse(fs::path const& src_file)
   auto ctx = x3::with<x3::error_handler_tag>(
       std::move(error_handler))[equilab::parser::file()];
 
+  // the AST is dropped at once, only the folder built from it is kept
+  detail::scoped_arena const arena;
   std::vector<equilab::parser::ast::entry> entries;
   auto b = utf32.begin();
   auto e = utf32.end();
@@ -1,14 +1,16 @@
 #include <prc/equilab/serialize.hpp>
 
+#include <prc/detail/format.hpp>
+#include <prc/detail/parallel.hpp>
+#include <prc/detail/profile.hpp>
+#include <prc/detail/render_cache.hpp>
 #include <prc/detail/unicode.hpp>
 
 #include <boost/algorithm/string/join.hpp>
 
 #include <cassert>
-#include <iomanip>
-#include <iostream>
 #include <numeric>
-#include <sstream>
+#include <ostream>
 
 using namespace std::string_literals;
 
@@ -31,6 +33,10 @@ inline auto const delim = "\xc2\xb0"s;
 class serializer
 {
 public:
+  explicit serializer(int depth = 1) : _depth(depth)
+  {
+  }
+
   std::string operator()(prc::folder const& f) const
   {
     std::string content(_depth, '.');
@@ -54,7 +60,7 @@ public:
     for (auto const& subrange : subranges)
     {
       current_index++;
-      content += (*this)(subrange.elems());
+      content += elems_string(subrange);
       content += delim + std::to_string(current_index) + delim +
                  std::to_string(parent_index) + delim +
                  rgb_to_string(subrange.rgb()) + delim + subrange.name() +
@@ -77,7 +83,7 @@ public:
   {
     std::string content(_depth, '.');
     content += r.name() + " {";
-    content += (*this)(r.elems());
+    content += elems_string(r);
     if (!r.subranges().empty())
     {
       content += delim + '0' + delim + '0' + delim + rgb_to_string(0xc0c0c0) +
@@ -91,19 +97,19 @@ public:
 
   std::string operator()(prc::range::weighted_elems const& we) const
   {
-    std::stringstream wss;
-    wss << std::fixed << std::setprecision(6) << we.weight;
-    auto const weight_str = wss.str();
+    auto content =
+        detail::format_double(we.weight, detail::equilab_weight_format);
     if (we.elems == any_two())
-      return weight_str + ":random";
-    std::vector<std::string> strs;
+      return content + ":random";
+    content += ':';
     for (auto const& elem : we.elems)
     {
-      std::stringstream ss;
-      ss << elem;
-      strs.push_back(ss.str());
+      content += elem.string();
+      content += ',';
     }
-    return weight_str + ":" + boost::algorithm::join(strs, ",");
+    if (!we.elems.empty())
+      content.pop_back();
+    return content;
   }
 
   std::string operator()(
@@ -117,15 +123,82 @@ public:
   }
 
 private:
-  int mutable _depth{1};
+  std::string const& elems_string(prc::range const& r) const
+  {
+    return _cache.get(r, [&](std::string& out) { out += (*this)(r.elems()); });
+  }
+
+  int mutable _depth;
+  detail::render_cache mutable _cache;
 };
+
+auto const header = "[Userdefined]\n"s;
+
+detail::profile_timer serialize_timer{"equilab::serialize"};
 }
 
-std::u16string serialize(prc::folder const& f)
+std::u16string serialize(prc::folder const& f, detail::thread_pool* pool)
 {
-  std::string content = "[Userdefined]\n";
-  for (auto const& entry : f.entries())
-    content += boost::variant2::visit(serializer{}, entry);
+  detail::scoped_timer const timer{serialize_timer};
+  if (!pool || pool->nb_workers() == 0)
+  {
+    std::string content = header;
+    serializer const s;
+    for (auto const& entry : f.entries())
+      content += boost::variant2::visit(s, entry);
+    return detail::utf8_to_utf16le(content);
+  }
+
+  auto const chunks = detail::split_subtrees(f, 4 * (pool->nb_workers() + 1));
+  std::vector<std::string> contents(chunks.size());
+  detail::parallel_for(*pool, chunks.size(), [&](std::size_t i) {
+    auto const& chunk = chunks[i];
+    if (chunk.header)
+    {
+      contents[i].assign(chunk.depth, '.');
+      contents[i] += chunk.header->name() + '\n';
+    }
+    else
+    {
+      contents[i] =
+          boost::variant2::visit(serializer{chunk.depth}, *chunk.entry);
+    }
+  });
+  auto size = header.size();
+  for (auto const& c : contents)
+    size += c.size();
+  std::string content;
+  content.reserve(size);
+  content += header;
+  for (auto const& c : contents)
+    content += c;
   return detail::utf8_to_utf16le(content);
 }
+
+stream_serializer::stream_serializer(std::ostream& os) : _os(os)
+{
+  write(header);
+}
+
+void stream_serializer::open_folder(std::string const& name)
+{
+  write(std::string(_depth++, '.') + name + '\n');
+}
+
+void stream_serializer::close_folder()
+{
+  assert(_depth > 1);
+  --_depth;
+}
+
+void stream_serializer::add_range(prc::range const& r)
+{
+  write(serializer{_depth}(r));
+}
+
+void stream_serializer::write(std::string const& utf8)
+{
+  auto const utf16 = detail::utf8_to_utf16le(utf8);
+  _os.write(reinterpret_cast<char const*>(utf16.data()), 2 * utf16.size());
+}
 }
@@ -1,5 +1,7 @@
 #include <prc/folder.hpp>
 
+#include <boost/container_hash/hash.hpp>
+
 #include <iomanip>
 #include <iostream>
 
@@ -8,7 +10,7 @@ namespace prc
 namespace
 {
 auto const get_depth = [](auto const& e) { return e.depth; };
-auto const get_name = [](auto const& e) { return e.name(); };
+auto const get_name_handle = [](auto const& e) { return e.name_handle(); };
 
 template <typename I, typename S>
 void recurse_entries(I& current,
@@ -32,12 +34,12 @@ void recurse_entries(I& current,
         if (subfolder_depth > depth)
           recurse_entries(current, end, new_folder, subfolder_depth);
       }
-      parent_folder.add_entry(new_folder);
+      parent_folder.add_entry(std::move(new_folder));
     }
     else
     {
       auto& r = boost::get<equilab::parser::ast::range>(*current);
-      parent_folder.add_entry(prc::range(r));
+      parent_folder.emplace_entry<range>(r);
       ++current;
     }
   }
@@ -58,7 +60,7 @@ void print_subranges(std::ostream& os,
 }
 }
 
-folder::folder(std::string name) : _name(std::move(name))
+folder::folder(std::string name) : _name(name)
 {
 }
 
@@ -72,50 +74,92 @@ folder::folder(std::string name,
 
 void folder::add_entry(folder const& f)
 {
-  _entries.push_back(f);
+  _hash.reset();
+  _entries.mut().push_back(f);
+}
+
+void folder::add_entry(folder&& f)
+{
+  _hash.reset();
+  _entries.mut().push_back(std::move(f));
 }
 
 void folder::add_entry(range const& r)
 {
-  _entries.push_back(r);
+  _hash.reset();
+  _entries.mut().push_back(r);
+}
+
+void folder::add_entry(range&& r)
+{
+  _hash.reset();
+  _entries.mut().push_back(std::move(r));
 }
 
 void folder::remove_entry(std::string const& name)
 {
-  auto s = _entries.size();
-  _entries.erase(std::remove_if(_entries.begin(),
-                                _entries.end(),
-                                [&name](auto& e) {
-                                  return boost::variant2::visit(get_name, e) ==
-                                         name;
-                                }),
-                 _entries.end());
+  auto const handle = interned_name::find(name);
+  if (!handle)
+    return;
+  _hash.reset();
+  auto& entries = _entries.mut();
+  entries.erase(std::remove_if(entries.begin(),
+                               entries.end(),
+                               [&](auto& e) {
+                                 return boost::variant2::visit(
+                                            get_name_handle, e) == *handle;
+                               }),
+                entries.end());
 }
 
 void folder::set_name(std::string n)
 {
-  _name = std::move(n);
+  _hash.reset();
+  _name = interned_name{n};
 }
 
 std::string const& folder::name() const
+{
+  return _name.str();
+}
+
+interned_name folder::name_handle() const
 {
   return _name;
 }
 
 auto folder::entries() const -> std::vector<entry> const&
 {
-  return _entries;
+  return _entries.get();
 }
 
 auto folder::entries() -> std::vector<entry>&
 {
-  return _entries;
+  _hash.reset();
+  return _entries.mut();
+}
+
+std::size_t folder::hash() const
+{
+  return _hash.get([this] {
+    std::size_t h = 0;
+    boost::hash_combine(h, _name.id());
+    for (auto const& e : entries())
+    {
+      boost::hash_combine(h, e.index());
+      boost::hash_combine(
+          h, boost::variant2::visit([](auto const& v) { return v.hash(); }, e));
+    }
+    return h;
+  });
 }
 
 bool operator==(folder const& lhs, folder const& rhs)
 {
-  return std::tie(lhs.name(), lhs.entries()) ==
-         std::tie(rhs.name(), rhs.entries());
+  if (lhs.name_handle() != rhs.name_handle())
+    return false;
+  // unmodified copies share their entries
+  return &lhs.entries() == &rhs.entries() || lhs.entries() == rhs.entries();
 }
 
 bool operator!=(folder const& lhs, folder const& rhs)
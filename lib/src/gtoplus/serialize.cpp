@@ -1,23 +1,27 @@
 #include <prc/gtoplus/serialize.hpp>
 
-#include <prc/detail/unicode.hpp>
+#include <prc/detail/binary_writer.hpp>
+#include <prc/detail/format.hpp>
+#include <prc/detail/parallel.hpp>
+#include <prc/detail/profile.hpp>
+#include <prc/detail/render_cache.hpp>
+#include <prc/interned_name.hpp>
 #include <prc/range_elem.hpp>
 
-#include <cstring>
-#include <fstream>
-#include <iomanip>
-#include <iostream>
-#include <map>
+#include <cassert>
+#include <iterator>
 #include <optional>
-#include <sstream>
+#include <string_view>
 
 namespace prc::gtoplus
 {
 namespace
 {
+detail::profile_timer serialize_timer{"gtoplus::serialize"};
+
 struct group_name_rgb
 {
-  std::string name;
+  interned_name name;
   int rgb;
 };
 
@@ -94,7 +98,7 @@ private:
 class range_elem_expander
 {
 public:
-  range_elem_expander(std::back_insert_iterator<std::vector<range_elem>> out)
+  range_elem_expander(std::back_insert_iterator<range_elems> out)
     : _out{out}
   {
   }
@@ -118,7 +122,7 @@ public:
   }
 
 private:
-  std::back_insert_iterator<std::vector<range_elem>> mutable _out;
+  std::back_insert_iterator<range_elems> mutable _out;
 };
 
 std::string rgb_to_string(int rgb)
@@ -209,177 +213,207 @@ auto const& sorted_hands()
   return ret;
 }
 
-std::string to_little_word(std::uint16_t n)
-{
-  std::string ret(2, '\0');
-  std::memcpy(
-      ret.data(), reinterpret_cast<char const*>(&n), sizeof(std::uint16_t));
-  return ret;
-}
-
-std::string to_little_dword(int n)
-{
-  std::string ret(4, '\0');
-  std::memcpy(ret.data(), reinterpret_cast<char const*>(&n), sizeof(int));
-  return ret;
-}
-
-std::string to_radix_double(double d)
+void write_utf16_string(detail::binary_writer& writer, std::string_view utf8)
 {
-  std::string ret(8, '\0');
-
-  std::memcpy(ret.data(), reinterpret_cast<char const*>(&d), sizeof(double));
-  return ret;
-}
-
-std::string to_utf16_string(std::string const& utf8)
-{
-  auto ret = to_little_dword(0x65) + '\xff' + '\xfe';
-  auto const utf16 = detail::utf8_to_utf16le(utf8);
-  auto const nb_code_units = utf16.size();
+  writer.write_dword(0x65);
+  writer.write_byte(0xff);
+  writer.write_byte(0xfe);
+  auto const nb_code_units = detail::utf16_length(utf8);
   if (nb_code_units > 30'000)
     throw std::runtime_error("utf16 size must be <= 60 000");
-  ret += "\xff";
+  writer.write_byte(0xff);
   // 255 must be encoded on two bytes, else you get two 0xff which breaks the
   // format
   if (nb_code_units >= 0xff)
   {
-    ret += "\xff";
-    ret += to_little_word(nb_code_units);
+    writer.write_byte(0xff);
+    writer.write_word(nb_code_units);
   }
   else
   {
-    ret += static_cast<char>(nb_code_units);
+    writer.write_byte(nb_code_units);
   }
-  ret += std::string(reinterpret_cast<char const*>(utf16.data()),
-                     utf16.size() * 2);
-  return ret;
+  writer.write_utf16le(utf8);
 }
 
-std::string to_category(prc::folder const& f)
+void write_category(detail::binary_writer& writer, prc::folder const& f)
 {
-  auto ret = to_little_dword(0x00003039);
+  writer.write_dword(0x00003039);
   if (f.name() == "/")
-    ret += to_utf16_string("default_name");
+    write_utf16_string(writer, "default_name");
   else
-    ret += to_utf16_string(f.name());
-  ret += to_little_dword(0);
-  ret += static_cast<char>(1) + to_little_dword(0) + to_little_dword(0) +
-         to_little_dword(f.entries().size());
-  return ret;
+    write_utf16_string(writer, f.name());
+  writer.write_dword(0);
+  writer.write_byte(1);
+  writer.write_dword(0);
+  writer.write_dword(0);
+  writer.write_dword(f.entries().size());
 }
 
-std::string to_range_content(
-    std::vector<prc::range::weighted_elems> const& elems)
+void render_range_content(std::string& scratch,
+                          std::vector<prc::range::weighted_elems> const& elems)
 {
-  std::stringstream ss;
   for (auto const& [w, e] : elems)
   {
-    ss << '[' << w << ']';
+    scratch += '[';
+    detail::append_double(scratch, w, detail::gtoplus_weight_format);
+    scratch += ']';
     for (auto i = 0; i < e.size(); ++i)
     {
       // GTO+ doesn't like when hand ranges are low-high, must be high-low
       if (auto hr = e[i].get_if<prc::hand_range>())
-        ss << hr->to() << '-' << hr->from();
+      {
+        scratch += hr->to().string();
+        scratch += '-';
+        scratch += hr->from().string();
+      }
       else
-        ss << e[i];
+        scratch += e[i].string();
       if (i != e.size() - 1)
-        ss << ',';
+        scratch += ',';
     }
-    ss << "[/" << w << "],";
+    scratch += "[/";
+    detail::append_double(scratch, w, detail::gtoplus_weight_format);
+    scratch += "],";
   }
-  auto utf8 = ss.str();
-  if (!utf8.empty())
-    utf8.pop_back();
-  return to_utf16_string(utf8);
+  if (!scratch.empty())
+    scratch.pop_back();
+}
+
+std::ptrdiff_t group_index(std::vector<group_name_rgb> const& group_names_rgbs,
+                           prc::range const& sub)
+{
+  auto const group_it = std::find_if(
+      group_names_rgbs.begin(), group_names_rgbs.end(), [&](auto& g) {
+        return g.rgb == sub.rgb();
+      });
+  if (group_it == group_names_rgbs.end())
+    throw std::runtime_error{"cannot find group name, should not happen!"};
+  return std::distance(group_names_rgbs.begin(), group_it);
 }
 
-std::string to_group_info(std::vector<prc::range> const& subranges,
-                          std::vector<group_name_rgb>& group_names_rgbs)
+void write_group_info(detail::binary_writer& writer,
+                      std::vector<prc::range> const& subranges,
+                      std::vector<group_name_rgb> const& group_names_rgbs)
 {
-  std::string ret;
   for (auto const& sub : subranges)
   {
-    auto const group_it = std::find_if(
-        group_names_rgbs.begin(), group_names_rgbs.end(), [&](auto& g) {
-          return g.rgb == sub.rgb();
-        });
-    auto const idx = std::distance(group_names_rgbs.begin(), group_it);
-    if (group_it == group_names_rgbs.end())
-      group_names_rgbs.push_back({sub.name(), sub.rgb()});
-    ret += to_little_dword(0x00003039) + to_utf16_string(sub.name()) +
-           to_little_dword(0) + '\x01' + to_little_dword(2) +
-           to_little_dword(idx) + to_little_dword(0);
+    writer.write_dword(0x00003039);
+    write_utf16_string(writer, sub.name());
+    writer.write_dword(0);
+    writer.write_byte(1);
+    writer.write_dword(2);
+    writer.write_dword(group_index(group_names_rgbs, sub));
+    writer.write_dword(0);
+  }
+}
+
+// groups are numbered by order of first appearance, resolving them before
+// serializing lets subtrees be written independently
+void collect_group_names_rgbs(prc::folder const& f,
+                              std::vector<group_name_rgb>& group_names_rgbs)
+{
+  for (auto const& entry : f.entries())
+  {
+    if (auto sub = boost::variant2::get_if<prc::folder>(&entry))
+    {
+      collect_group_names_rgbs(*sub, group_names_rgbs);
+      continue;
+    }
+    for (auto const& sub : boost::variant2::get<prc::range>(entry).subranges())
+    {
+      auto const group_it = std::find_if(
+          group_names_rgbs.begin(), group_names_rgbs.end(), [&](auto& g) {
+            return g.rgb == sub.rgb();
+          });
+      if (group_it == group_names_rgbs.end())
+        group_names_rgbs.push_back({sub.name_handle(), sub.rgb()});
+    }
   }
-  return ret;
 }
 
-std::string to_hand_info(std::vector<prc::range> const& subranges,
-                         std::vector<group_name_rgb> const& group_names_rgbs)
+void write_hand_info(detail::binary_writer& writer,
+                     std::vector<prc::range> const& subranges,
+                     std::vector<group_name_rgb> const& group_names_rgbs)
 {
-  std::string ret;
   auto const& all_hands = sorted_hands();
-  std::vector<hand_info> info;
   for (auto i = 0; i < all_hands.size(); ++i)
   {
     auto const opt_info =
         get_hand_info(all_hands[i], subranges, group_names_rgbs);
-    if (opt_info)
-      info.push_back(*opt_info);
-    else
-      info.push_back(hand_info{{{0, 1.0}}});
-  }
-  for (auto const& elem : info)
-  {
-    ret += to_little_dword(0x84) + to_little_dword(elem.index_to_ratio.size());
-    for (auto const& [idx, ratio] : elem.index_to_ratio)
-      ret += to_little_dword(idx);
-    for (auto const& [idx, ratio] : elem.index_to_ratio)
-      ret += to_radix_double(ratio);
+    auto const& info = opt_info ? *opt_info : hand_info{{{0, 1.0}}};
+
+    writer.write_dword(0x84);
+    writer.write_dword(info.index_to_ratio.size());
+    for (auto const& [idx, ratio] : info.index_to_ratio)
+      writer.write_dword(idx);
+    for (auto const& [idx, ratio] : info.index_to_ratio)
+      writer.write_double(ratio);
   }
-  return ret;
 }
 
-std::string to_range(prc::range const& r,
-                     std::vector<group_name_rgb>& group_names_rgbs)
+class serializer
 {
-  auto ret = to_little_dword(0x00003039);
-  ret += to_utf16_string(r.name()) + to_little_dword(0);
-  if (r.subranges().empty())
-    ret += '\x00';
-  else
-    ret += '\x01';
-  ret += to_little_dword(1) + to_little_dword(0) +
-         to_little_dword(r.subranges().size());
-  ret += to_group_info(r.subranges(), group_names_rgbs);
-  ret += to_range_content(r.elems());
-  ret += to_hand_info(r.subranges(), group_names_rgbs);
-  ret += to_little_dword(r.subranges().size());
-  for (auto const& sub : r.subranges())
+public:
+  serializer(std::size_t capacity,
+             std::vector<group_name_rgb> const& group_names_rgbs)
+    : _writer(capacity), _group_names_rgbs(group_names_rgbs)
   {
-    auto const group_it = std::find_if(
-        group_names_rgbs.begin(), group_names_rgbs.end(), [&](auto& g) {
-          return g.rgb == sub.rgb();
-        });
-    auto const idx = std::distance(group_names_rgbs.begin(), group_it);
-    if (group_it == group_names_rgbs.end())
-      throw std::runtime_error{"cannot find group name, should not happen!"};
-    ret += to_little_dword(idx);
   }
-  return ret;
-}
 
-std::string serialize_impl(prc::folder const& parent_folder,
-                           std::vector<group_name_rgb>& group_names_rgbs)
+  void operator()(prc::folder const& parent_folder)
+  {
+    write_category(_writer, parent_folder);
+    for (auto const& entry : parent_folder.entries())
+      boost::variant2::visit(*this, entry);
+  }
+
+  void operator()(prc::range const& r)
+  {
+    _writer.write_dword(0x00003039);
+    write_utf16_string(_writer, r.name());
+    _writer.write_dword(0);
+    _writer.write_byte(r.subranges().empty() ? 0 : 1);
+    _writer.write_dword(1);
+    _writer.write_dword(0);
+    _writer.write_dword(r.subranges().size());
+    write_group_info(_writer, r.subranges(), _group_names_rgbs);
+    write_utf16_string(_writer, _cache.get(r, [&](std::string& out) {
+      render_range_content(out, r.elems());
+    }));
+    write_hand_info(_writer, r.subranges(), _group_names_rgbs);
+    _writer.write_dword(r.subranges().size());
+    for (auto const& sub : r.subranges())
+      _writer.write_dword(group_index(_group_names_rgbs, sub));
+  }
+
+  void write_header(prc::folder const& f)
+  {
+    write_category(_writer, f);
+  }
+
+  std::string release()
+  {
+    return _writer.release();
+  }
+
+private:
+  detail::binary_writer _writer;
+  std::vector<group_name_rgb> const& _group_names_rgbs;
+  // range contents, its scratch string also avoids allocating for each range
+  detail::render_cache _cache;
+};
+
+// a range with subranges takes around 4KB (mostly hand info), names aside
+std::size_t estimate_size(prc::folder const& f)
 {
-  auto ret = to_category(parent_folder);
-  for (auto const& entry : parent_folder.entries())
+  std::size_t ret = 64;
+  for (auto const& entry : f.entries())
   {
-    if (auto f = boost::variant2::get_if<prc::folder>(&entry))
-      ret += serialize_impl(*f, group_names_rgbs);
+    if (auto sub = boost::variant2::get_if<prc::folder>(&entry))
+      ret += estimate_size(*sub);
     else
-      ret +=
-          to_range(boost::variant2::get<prc::range>(entry), group_names_rgbs);
+      ret += 4096;
   }
   return ret;
 }
@@ -415,12 +449,54 @@ std::string serialize_settings(
 }
 }
 
-serialized_content serialize(prc::folder const& f)
+serialized_content serialize(prc::folder const& f, detail::thread_pool* pool)
 {
+  detail::scoped_timer const timer{serialize_timer};
   serialized_content ret;
   std::vector<group_name_rgb> group_names_rgbs;
-  ret.newdefs3 = serialize_impl(f, group_names_rgbs);
+  collect_group_names_rgbs(f, group_names_rgbs);
   ret.settings = serialize_settings(group_names_rgbs);
+
+  if (!pool || pool->nb_workers() == 0)
+  {
+    serializer s{estimate_size(f), group_names_rgbs};
+    s(f);
+    ret.newdefs3 = s.release();
+    return ret;
+  }
+
+  auto const chunks = detail::split_subtrees(f, 4 * (pool->nb_workers() + 1));
+  std::vector<std::string> contents(chunks.size());
+  detail::parallel_for(*pool, chunks.size(), [&](std::size_t i) {
+    auto const& chunk = chunks[i];
+    if (chunk.header)
+    {
+      serializer s{64, group_names_rgbs};
+      s.write_header(*chunk.header);
+      contents[i] = s.release();
+    }
+    else if (auto sub = boost::variant2::get_if<prc::folder>(chunk.entry))
+    {
+      serializer s{estimate_size(*sub), group_names_rgbs};
+      s(*sub);
+      contents[i] = s.release();
+    }
+    else
+    {
+      serializer s{4096, group_names_rgbs};
+      s(boost::variant2::get<prc::range>(*chunk.entry));
+      contents[i] = s.release();
+    }
+  });
+  serializer root{64, group_names_rgbs};
+  root.write_header(f);
+  ret.newdefs3 = root.release();
+  auto size = ret.newdefs3.size();
+  for (auto const& c : contents)
+    size += c.size();
+  ret.newdefs3.reserve(size);
+  for (auto const& c : contents)
+    ret.newdefs3 += c;
   return ret;
 }
 }
@@ -1,38 +1,101 @@
 #include <prc/hand.hpp>
 
+#include <array>
 #include <sstream>
 
 namespace prc
 {
-hand::hand(unpaired_hand const& uh) : _v(uh)
+namespace
 {
+constexpr int nb_pairs = 13;
+
+struct hand_ranks
+{
+  std::uint8_t high;
+  std::uint8_t low;
+  bool suited;
+};
+
+// ranks of each hand id, pairs have high == low
+constexpr auto hands_ranks = [] {
+  std::array<hand_ranks, 169> ret{};
+  std::size_t i = 0;
+  for (std::uint8_t r = 0; r < nb_pairs; ++r)
+    ret[i++] = {r, r, false};
+  for (std::uint8_t high = 1; high < nb_pairs; ++high)
+  {
+    for (std::uint8_t low = 0; low < high; ++low)
+    {
+      ret[i++] = {high, low, false};
+      ret[i++] = {high, low, true};
+    }
+  }
+  return ret;
+}();
+
+std::uint8_t unpaired_hand_id(unpaired_hand const& uh)
+{
+  auto const high = static_cast<int>(uh.high());
+  auto const low = static_cast<int>(uh.low());
+  return static_cast<std::uint8_t>(
+      nb_pairs + (high * (high - 1) / 2 + low) * 2 + uh.suited());
+}
 }
 
-hand::hand(paired_hand ph) : _v(ph)
+hand::hand(unpaired_hand const& uh) : _id(unpaired_hand_id(uh))
+{
+}
+
+hand::hand(paired_hand ph) : _id(static_cast<std::uint8_t>(ph.rank()))
 {
 }
 
 hand::hand(parser::ast::hand const& h)
 {
   if (auto p = boost::get<parser::ast::unpaired_hand>(&h))
-    _v = unpaired_hand{*p};
+    *this = hand{unpaired_hand{*p}};
   else
-    _v = paired_hand{boost::get<parser::ast::paired_hand>(h)};
+    *this = hand{paired_hand{boost::get<parser::ast::paired_hand>(h)}};
+}
+
+hand hand::from_id(std::uint8_t id)
+{
+  hand h;
+  h._id = id;
+  return h;
+}
+
+paired_hand hand::to_paired_hand() const
+{
+  return paired_hand{static_cast<rank>(_id)};
+}
+
+unpaired_hand hand::to_unpaired_hand() const
+{
+  auto const& r = hands_ranks[_id];
+  return unpaired_hand{static_cast<rank>(r.high),
+                       static_cast<rank>(r.low),
+                       r.suited ? suitedness::suited : suitedness::offsuit};
+}
+
+std::uint8_t hand::id() const
+{
+  return _id;
 }
 
 std::string hand::string() const
 {
-  return boost::variant2::visit([](auto& e) { return e.string(); }, _v);
+  return visit([](auto const& e) { return e.string(); });
 }
 
 int hand::index() const
 {
-  return _v.index();
+  return _id < nb_pairs ? 0 : 1;
 }
 
 bool operator==(hand const& lhs, hand const& rhs)
 {
-  return lhs._v == rhs._v;
+  return lhs._id == rhs._id;
 }
 
 bool operator!=(hand const& lhs, hand const& rhs)
@@ -42,7 +105,7 @@ bool operator!=(hand const& lhs, hand const& rhs)
 
 bool operator<(hand const& lhs, hand const& rhs)
 {
-  return lhs._v < rhs._v;
+  return lhs._id < rhs._id;
 }
 
 std::ostream& operator<<(std::ostream& os, hand const& h)
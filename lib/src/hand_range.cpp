@@ -1,6 +1,6 @@
 #include <prc/hand_range.hpp>
 
-#include <sstream>
+#include <ostream>
 #include <stdexcept>
 #include <tuple>
 
@@ -32,9 +32,7 @@ hand const& hand_range::to() const
 std::string hand_range::string() const
 {
   // all softwares do not support XX+
-  std::stringstream ss;
-  ss << _from << '-' << _to;
-  return ss.str();
+  return _from.string() + '-' + _to.string();
 }
 
 bool operator==(hand_range const& lhs, hand_range const& rhs)
@@ -0,0 +1,107 @@
+#include <prc/interned_name.hpp>
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace prc
+{
+namespace
+{
+constexpr std::size_t chunk_size = 4096;
+constexpr std::size_t max_chunks = 4096;
+
+// Strings are stored in chunks which never move, an id is only handed out
+// once its string is written, so reading does not need the mutex.
+struct name_pool
+{
+  name_pool()
+  {
+    insert("");
+  }
+
+  std::string const& get(std::uint32_t id) const
+  {
+    return chunks[id / chunk_size][id % chunk_size];
+  }
+
+  std::uint32_t insert(std::string_view str)
+  {
+    if (size == chunk_size * max_chunks)
+      throw std::length_error{"too many interned names"};
+    auto& chunk = chunks[size / chunk_size];
+    if (!chunk)
+      chunk = std::make_unique<std::string[]>(chunk_size);
+    auto& s = chunk[size % chunk_size];
+    s = str;
+    ids.emplace(s, size);
+    return size++;
+  }
+
+  std::shared_mutex mutex;
+  std::unordered_map<std::string_view, std::uint32_t> ids;
+  std::array<std::unique_ptr<std::string[]>, max_chunks> chunks;
+  std::uint32_t size = 0;
+};
+
+name_pool& get_pool()
+{
+  static name_pool pool;
+  return pool;
+}
+}
+
+interned_name::interned_name(std::string_view str)
+{
+  auto& pool = get_pool();
+  {
+    std::shared_lock lock{pool.mutex};
+    if (auto it = pool.ids.find(str); it != pool.ids.end())
+    {
+      _id = it->second;
+      return;
+    }
+  }
+  std::unique_lock lock{pool.mutex};
+  if (auto it = pool.ids.find(str); it != pool.ids.end())
+    _id = it->second;
+  else
+    _id = pool.insert(str);
+}
+
+interned_name::interned_name(std::uint32_t id) : _id{id}
+{
+}
+
+std::optional<interned_name> interned_name::find(std::string_view str)
+{
+  auto& pool = get_pool();
+  std::shared_lock lock{pool.mutex};
+  if (auto it = pool.ids.find(str); it != pool.ids.end())
+    return interned_name{it->second};
+  return std::nullopt;
+}
+
+std::string const& interned_name::str() const
+{
+  return get_pool().get(_id);
+}
+
+std::uint32_t interned_name::id() const
+{
+  return _id;
+}
+
+bool operator==(interned_name lhs, interned_name rhs)
+{
+  return lhs.id() == rhs.id();
+}
+
+bool operator!=(interned_name lhs, interned_name rhs)
+{
+  return !(lhs == rhs);
+}
+}
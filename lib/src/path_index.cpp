@@ -0,0 +1,194 @@
+#include <prc/path_index.hpp>
+
+#include <algorithm>
+
+namespace prc
+{
+namespace
+{
+constexpr std::uint32_t npos = static_cast<std::uint32_t>(-1);
+
+std::uint64_t child_key(std::uint32_t parent, interned_name name)
+{
+  return (std::uint64_t{parent} << 32) | name.id();
+}
+}
+
+path_index::path_index(folder& root) : _root{root}
+{
+  add_node(npos, root.name_handle(), 0, false);
+  add_children(0, root);
+}
+
+auto path_index::add_node(index parent,
+                          interned_name name,
+                          index pos,
+                          bool is_range) -> index
+{
+  auto const i = static_cast<index>(_nodes.size());
+  _nodes.push_back({name, parent, pos, is_range, {}});
+  if (parent != npos)
+  {
+    _nodes[parent].children.push_back(i);
+    _children.try_emplace(child_key(parent, name), i);
+  }
+  return i;
+}
+
+void path_index::add_children(index i, folder const& f)
+{
+  auto const& entries = f.entries();
+  for (index pos = 0; pos < entries.size(); ++pos)
+  {
+    if (auto sub = boost::variant2::get_if<folder>(&entries[pos]))
+      add_children(add_node(i, sub->name_handle(), pos, false), *sub);
+    else
+    {
+      auto& r = boost::variant2::get<range>(entries[pos]);
+      add_children(add_node(i, r.name_handle(), pos, true), r);
+    }
+  }
+}
+
+void path_index::add_children(index i, range const& r)
+{
+  auto const& subranges = r.subranges();
+  for (index pos = 0; pos < subranges.size(); ++pos)
+  {
+    auto const& sub = subranges[pos];
+    add_children(add_node(i, sub.name_handle(), pos, true), sub);
+  }
+}
+
+auto path_index::find_child(index parent, interned_name name) const -> index
+{
+  auto const it = _children.find(child_key(parent, name));
+  return it != _children.end() ? it->second : npos;
+}
+
+auto path_index::find_node(std::string_view path) const -> index
+{
+  index current = 0;
+  std::size_t begin = 0;
+  while (begin <= path.size())
+  {
+    auto end = path.find('/', begin);
+    if (end == std::string_view::npos)
+      end = path.size();
+    auto const component = path.substr(begin, end - begin);
+    begin = end + 1;
+    if (component.empty())
+      continue;
+    auto const name = interned_name::find(component);
+    if (!name)
+      return npos;
+    current = find_child(current, *name);
+    if (current == npos)
+      return npos;
+  }
+  return current;
+}
+
+path_entry path_index::resolve(index i) const
+{
+  if (i == 0)
+    return {&_root, nullptr};
+  auto const& n = _nodes[i];
+  auto const parent = resolve(n.parent);
+  if (parent.r)
+    return {nullptr, &parent.r->subranges()[n.pos]};
+  auto const& e = parent.f->entries()[n.pos];
+  if (auto f = boost::variant2::get_if<folder>(&e))
+    return {f, nullptr};
+  return {nullptr, &boost::variant2::get<range>(e)};
+}
+
+auto path_index::resolve_mutable(index i) -> mutable_entry
+{
+  if (i == 0)
+    return {&_root, nullptr};
+  auto const& n = _nodes[i];
+  auto const parent = resolve_mutable(n.parent);
+  if (parent.r)
+    return {nullptr, &parent.r->subranges()[n.pos]};
+  auto& e = parent.f->entries()[n.pos];
+  if (auto f = boost::variant2::get_if<folder>(&e))
+    return {f, nullptr};
+  return {nullptr, &boost::variant2::get<range>(e)};
+}
+
+path_entry path_index::find(std::string_view path) const
+{
+  auto const i = find_node(path);
+  return i != npos ? resolve(i) : path_entry{};
+}
+
+void path_index::list_subtree(index i,
+                              std::string const& parent_path,
+                              std::vector<std::string>& out) const
+{
+  auto const& n = _nodes[i];
+  auto const path = parent_path + '/' + n.name.str();
+  out.push_back(path);
+  for (auto const c : n.children)
+    list_subtree(c, path, out);
+}
+
+std::vector<std::string> path_index::list(std::string_view prefix) const
+{
+  auto const last_slash = prefix.rfind('/');
+  auto const dir = last_slash == std::string_view::npos
+                       ? std::string_view{}
+                       : prefix.substr(0, last_slash + 1);
+  auto const partial = prefix.substr(dir.size());
+  std::vector<std::string> ret;
+  auto const d = find_node(dir);
+  if (d == npos)
+    return ret;
+  std::string dir_path;
+  for (auto i = d; i != 0; i = _nodes[i].parent)
+    dir_path.insert(0, '/' + _nodes[i].name.str());
+  for (auto const c : _nodes[d].children)
+  {
+    auto const& name = _nodes[c].name.str();
+    if (std::string_view{name}.substr(0, partial.size()) == partial)
+      list_subtree(c, dir_path, ret);
+  }
+  return ret;
+}
+
+bool path_index::remove(std::string_view path)
+{
+  auto const i = find_node(path);
+  if (i == npos || i == 0)
+    return false;
+  auto const p = _nodes[i].parent;
+  auto const pos = _nodes[i].pos;
+  auto const name = _nodes[i].name;
+  auto const parent = resolve_mutable(p);
+  if (parent.r)
+    parent.r->subranges().erase(parent.r->subranges().begin() + pos);
+  else
+    parent.f->entries().erase(parent.f->entries().begin() + pos);
+
+  // siblings are ordered by position, the removed node's subtree is left
+  // unreachable
+  auto& siblings = _nodes[p].children;
+  for (auto it = siblings.begin() + pos + 1; it != siblings.end(); ++it)
+    --_nodes[*it].pos;
+  siblings.erase(siblings.begin() + pos);
+  auto const key = child_key(p, name);
+  if (_children.at(key) == i)
+  {
+    auto const it =
+        std::find_if(siblings.begin(), siblings.end(), [&](auto const c) {
+          return _nodes[c].name == name;
+        });
+    if (it != siblings.end())
+      _children[key] = *it;
+    else
+      _children.erase(key);
+  }
+  return true;
+}
+}
@@ -0,0 +1,91 @@
+#include <prc/pio/manifest.hpp>
+
+#include <prc/detail/hash.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <string_view>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+namespace prc::pio
+{
+namespace
+{
+constexpr auto manifest_filename = ".prc_manifest";
+}
+
+fs::path manifest_path(fs::path const& dst)
+{
+  return dst / manifest_filename;
+}
+
+manifest read_manifest(fs::path const& dst)
+{
+  manifest ret;
+  std::ifstream ifs{manifest_path(dst).string()};
+  std::string line;
+  while (std::getline(ifs, line))
+  {
+    std::uint64_t hash;
+    if (line.size() > 17 && line[16] == ' ' &&
+        detail::from_hex(std::string_view{line}.substr(0, 16), hash))
+      ret.emplace(line.substr(17), hash);
+  }
+  return ret;
+}
+
+void write_manifest(manifest const& m, fs::path const& dst)
+{
+  auto const path = manifest_path(dst);
+  auto tmp_path = path;
+  tmp_path += ".tmp";
+  {
+    std::ofstream ofs{tmp_path.string(), std::ios::trunc};
+    for (auto const& [filename, hash] : m)
+      ofs << detail::to_hex(hash) << ' ' << filename << '\n';
+  }
+  fs::rename(tmp_path, path);
+}
+
+bool is_unchanged(manifest const& old,
+                  std::string const& filename,
+                  std::uint64_t hash,
+                  fs::path const& dst)
+{
+  auto const path = dst / fs::path{filename};
+  if (!fs::exists(path))
+    return false;
+  if (auto it = old.find(filename); it != old.end())
+    return it->second == hash;
+  // no manifest yet, compare with what is on disk
+  std::ifstream ifs{path.string(), std::ios::binary};
+  std::string const content(std::istreambuf_iterator<char>(ifs), {});
+  return detail::fnv1a(content) == hash;
+}
+
+std::vector<fs::path> remove_stale_files(manifest const& old,
+                                         manifest const& current,
+                                         fs::path const& dst)
+{
+  std::vector<fs::path> ret;
+  for (auto const& [filename, hash] : old)
+  {
+    if (current.count(filename))
+      continue;
+    fs::path const rel_path{filename};
+    std::error_code ec;
+    if (fs::remove(dst / rel_path, ec))
+      ret.push_back(dst / rel_path);
+    // a previous file of the same directory may have removed it already
+    for (auto dir = rel_path.parent_path(); !dir.empty();
+         dir = dir.parent_path())
+    {
+      if (!fs::is_empty(dst / dir, ec) || ec || !fs::remove(dst / dir, ec))
+        break;
+    }
+  }
+  return ret;
+}
+}
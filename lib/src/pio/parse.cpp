@@ -1,10 +1,13 @@
 #include <prc/pio/parse.hpp>
 
+#include <prc/detail/arena.hpp>
+#include <prc/detail/profile.hpp>
 #include <prc/detail/unicode.hpp>
 #include <prc/pio/parser/api.hpp>
 
 #include <boost/spirit/home/x3.hpp>
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
@@ -16,6 +19,11 @@ namespace prc::pio
 {
 namespace
 {
+detail::profile_timer parse_folder_timer{"pio::parse_folder"};
+detail::profile_timer parse_range_timer{"pio::parse_range"};
+detail::profile_timer directory_scan_timer{"pio directory scan"};
+detail::profile_counter parsed_files{"pio files parsed"};
+
 std::u32string read_all(fs::path const& p)
 {
   if (!fs::exists(p))
@@ -26,58 +34,14 @@ std::u32string read_all(fs::path const& p)
   std::string content(std::istreambuf_iterator<char>(ifs), {});
   return detail::utf8_to_utf32(content);
 }
-
-template <typename I, typename S>
-void recurse_entries(I& current,
-                     S end,
-                     folder& parent_folder,
-                     fs::path const& parent_absolute_path)
-{
-  while (current != end)
-  {
-    auto const& current_path = *current;
-
-    if (current_path.parent_path() != parent_absolute_path)
-      return;
-    if (is_directory(current_path))
-    {
-      folder new_folder{current_path.filename().string()};
-
-      if (++current != end)
-      {
-        auto const& subfolder_path = *current;
-        if (subfolder_path.parent_path() == current_path)
-          recurse_entries(current, end, new_folder, current_path);
-      }
-      if (!new_folder.entries().empty())
-        parent_folder.add_entry(std::move(new_folder));
-    }
-    else
-    {
-      if (current_path.extension() == ".txt")
-      {
-        // TODO report error through a callback that could be used to show
-        // progress bar?
-        try
-        {
-          auto range = parse_range(current_path);
-          range.set_name(current_path.stem());
-          parent_folder.add_entry(std::move(range));
-        }
-        catch (std::exception const& e)
-        {
-          std::cerr << "An exception occurred while parsing " << current_path
-                    << ": " << e.what() << std::endl;
-        }
-      }
-      ++current;
-    }
-  }
-}
 }
 
 prc::range parse_range(fs::path const& pio_range_path)
 {
+  detail::scoped_timer const timer{parse_range_timer};
+  parsed_files.add();
+  // the ast and the conversion's temporaries are dropped with the arena
+  detail::scoped_arena const arena;
   auto const content = read_all(pio_range_path);
 
   x3::error_handler<std::u32string::const_iterator> error_handler(
@@ -92,17 +56,56 @@ prc::range parse_range(fs::path const& pio_range_path)
 
 folder parse_folder(fs::path const& pio_folder_path)
 {
-  prc::folder root{"/"};
+  detail::scoped_timer const timer{parse_folder_timer};
+  std::vector<prc::folder> folders;
+  folders.emplace_back("/");
+
+  walk_folder(pio_folder_path,
+              {[&](auto const& name) { folders.emplace_back(name); },
+               [&] {
+                 auto f = std::move(folders.back());
+                 folders.pop_back();
+                 if (!f.entries().empty())
+                   folders.back().add_entry(std::move(f));
+               },
+               [&](auto&& r) { folders.back().add_entry(std::move(r)); }});
+  return std::move(folders.front());
+}
+
+void walk_folder(fs::path const& current_path, folder_visitor const& visitor)
+{
   std::vector<fs::path> paths;
+  {
+    detail::scoped_timer const timer{directory_scan_timer};
+    for (auto& p : fs::directory_iterator{current_path})
+      paths.push_back(p.path());
+    std::sort(paths.begin(), paths.end());
+  }
 
-  for (auto& p : fs::recursive_directory_iterator{pio_folder_path})
-    paths.push_back(p.path());
-  if (paths.empty())
-    return root;
-  std::sort(paths.begin(), paths.end());
-  auto begin = paths.begin();
-  auto const end = paths.end();
-  recurse_entries(begin, end, root, pio_folder_path);
-  return root;
+  for (auto const& path : paths)
+  {
+    if (is_directory(path))
+    {
+      visitor.enter_folder(path.filename().string());
+      walk_folder(path, visitor);
+      visitor.leave_folder();
+    }
+    else if (path.extension() == ".txt")
+    {
+      // TODO report error through a callback that could be used to show
+      // progress bar?
+      try
+      {
+        auto range = parse_range(path);
+        range.set_name(path.stem());
+        visitor.visit_range(std::move(range));
+      }
+      catch (std::exception const& e)
+      {
+        std::cerr << "An exception occurred while parsing " << path << ": "
+                  << e.what() << std::endl;
+      }
+    }
+  }
 }
 }
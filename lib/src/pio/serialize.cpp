@@ -1,9 +1,9 @@
 #include <prc/combo.hpp>
+#include <prc/detail/format.hpp>
+#include <prc/detail/profile.hpp>
 #include <prc/pio/serialize.hpp>
 
 #include <algorithm>
-#include <iomanip>
-#include <sstream>
 
 using namespace std::string_literals;
 
@@ -11,6 +11,8 @@ namespace prc::pio
 {
 namespace
 {
+detail::profile_timer serialize_timer{"pio::serialize"};
+
 std::size_t index_of(combo const& c)
 {
   auto const& combos = any_two_combos();
@@ -21,7 +23,6 @@ std::size_t index_of(combo const& c)
 void write_combo_weights(std::string& content,
                          std::vector<range::weighted_elems> const& elems)
 {
-  auto const& combos = any_two_combos();
   std::vector<double> weights(1326);
   for (auto const& [w, e] : elems)
   {
@@ -29,30 +30,38 @@ void write_combo_weights(std::string& content,
       weights[index_of(c)] = w / 100.0;
   }
 
-  std::stringstream ss;
-  ss << std::fixed << std::setprecision(3);
   for (auto const w : weights)
   {
-    // avoid trailing zeros
-    if (w == 1.0 || w == 0.0)
-      ss << int(w) << ' ';
-    else
-      ss << w << ' ';
+    detail::append_double(content, w, detail::pio_weight_format);
+    content += ' ';
   }
-  content += ss.str();
   content.pop_back();
 }
 }
 
 std::string serialize(prc::range const& r)
 {
+  detail::render_cache cache;
+  return serialize(r, cache);
+}
+
+std::string serialize(prc::range const& r, detail::render_cache& cache)
+{
+  detail::scoped_timer const timer{serialize_timer};
   auto content = "PreflopCharts\n"s;
-  write_combo_weights(content, r.elems());
+  auto const write_weights = [&](prc::range const& from) {
+    content += cache.get(from, [&](std::string& out) {
+      write_combo_weights(out, from.elems());
+    });
+  };
+  // at most 5 characters per weight, plus separator
+  content.reserve((r.subranges().size() + 1) * 1326 * 6);
+  write_weights(r);
   content += '\n';
   for (auto const& sub : r.subranges())
   {
     content += "True\n" + std::to_string(sub.rgb()) + "\t" + sub.name() + "\t";
-    write_combo_weights(content, sub.elems());
+    write_weights(sub);
     content += '\n';
   }
   content.pop_back();
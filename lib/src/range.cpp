@@ -7,9 +7,11 @@
 #include <map>
 #include <ostream>
 #include <sstream>
+#include <unordered_map>
 #include <utility>
 
 #include <boost/algorithm/string/join.hpp>
+#include <boost/container_hash/hash.hpp>
 
 namespace prc
 {
@@ -18,10 +20,16 @@ namespace
 constexpr auto nb_total_combos = 1326;
 constexpr auto minimum_weight = 0.001;
 
+// runs in parse_range's arena, only the returned elems use the heap
 std::vector<range::weighted_elems> weights_to_weighted_elems(
-    std::vector<double> const& weights)
+    pio::parser::ast::weights const& weights)
 {
-  std::map<double, std::vector<combo>> m;
+  using weight_combos = std::pair<double const, combo_set>;
+  std::map<double,
+           combo_set,
+           std::less<>,
+           detail::arena_allocator<weight_combos>>
+      m;
   auto const& any_two = any_two_combos();
 
   for (auto i = 0; i < nb_total_combos; ++i)
@@ -30,7 +38,7 @@ std::vector<range::weighted_elems> weights_to_weighted_elems(
     // it can be reconstituted by expanding combos of all subranges, then
     // set_difference between that and the parent combos
     if (weights[i] > minimum_weight)
-      m[weights[i] * 100.0].push_back(any_two[i]);
+      m[weights[i] * 100.0].insert(any_two[i]);
   }
 
   std::vector<range::weighted_elems> ret;
@@ -40,10 +48,11 @@ std::vector<range::weighted_elems> weights_to_weighted_elems(
 }
 
 std::vector<range::weighted_elems> weights_to_weighted_elems(
-    std::vector<double> const& weights,
-    std::vector<double> const& parent_weights)
+    pio::parser::ast::weights const& weights,
+    pio::parser::ast::weights const& parent_weights)
 {
-  std::vector<double> adjusted_weights;
+  pio::parser::ast::weights adjusted_weights;
+  adjusted_weights.reserve(weights.size());
 
   // pio weights are absolute, e.g. parent has 0.8, child has 0.7, it means 70%
   // of 100%, not 70% of 80%
@@ -62,7 +71,7 @@ std::vector<range::weighted_elems> weights_to_weighted_elems(
   return weights_to_weighted_elems(adjusted_weights);
 }
 
-using weight_by_combo_t = std::map<prc::combo, double>;
+using weight_by_combo_t = std::unordered_map<prc::combo, double>;
 
 weight_by_combo_t weight_by_combos(
     std::vector<range::weighted_elems> const& elems)
@@ -98,7 +107,8 @@ std::vector<range::weighted_elems> unassigned_combos_to_weighted_elems(
 }
 
 std::vector<range::weighted_elems> equilab_weighted_hands_to_weighted_elems(
-    std::vector<equilab::parser::ast::weighted_hands> const& weighted_hands)
+    detail::arena_vector<equilab::parser::ast::weighted_hands> const&
+        weighted_hands)
 {
   std::vector<range::weighted_elems> ret;
   for (auto const& [weight, hands] : weighted_hands)
@@ -115,19 +125,29 @@ std::vector<range::weighted_elems> equilab_weighted_hands_to_weighted_elems(
   }
   return ret;
 }
+template <typename Ranges>
+auto find_by_name(Ranges& ranges, interned_name name) -> decltype(&ranges[0])
+{
+  auto it = std::find_if(ranges.begin(), ranges.end(), [&](auto& r) {
+    return r.name_handle() == name;
+  });
+  return it != ranges.end() ? std::addressof(*it) : nullptr;
+}
+
+// groups are sorted through pointers, to leave the ast untouched
 template <typename Iterator>
 Iterator order_equilab_groups(Iterator begin, Iterator end)
 {
-  std::sort(begin, end, [](auto& lhs, auto& rhs) {
-    if (lhs.info.value().nesting_index != rhs.info.value().nesting_index)
-      return lhs.info.value().nesting_index < rhs.info.value().nesting_index;
-    return lhs.info.value().index < rhs.info.value().index;
+  std::sort(begin, end, [](auto lhs, auto rhs) {
+    if (lhs->info.value().nesting_index != rhs->info.value().nesting_index)
+      return lhs->info.value().nesting_index < rhs->info.value().nesting_index;
+    return lhs->info.value().index < rhs->info.value().index;
   });
-  std::stable_sort(begin, end, [](auto& lhs, auto& rhs) {
-    return lhs.info.value().nesting_index > rhs.info.value().nesting_index;
+  std::stable_sort(begin, end, [](auto lhs, auto rhs) {
+    return lhs->info.value().nesting_index > rhs->info.value().nesting_index;
   });
   return std::find_if(
-      begin, end, [](auto& g) { return g.info.value().nesting_index == 0; });
+      begin, end, [](auto g) { return g->info.value().nesting_index == 0; });
 }
 
 template <typename Iterator, typename Sentinel>
@@ -136,23 +156,25 @@ std::vector<range> nest_equilab_ranges(Iterator begin, Sentinel end)
   // far from being optimized nor pretty, but heh
   auto const first_non_nested = order_equilab_groups(begin, end);
 
-  std::map<int, int> index_to_pos;
+  std::unordered_map<int, int> index_to_pos;
   for (auto it = begin; it != end; ++it)
-    index_to_pos[it->info->index] = std::distance(begin, it);
+    index_to_pos[(*it)->info->index] = std::distance(begin, it);
 
   std::vector<range> subranges;
-  std::transform(begin, end, std::back_inserter(subranges), [](auto& g) {
-    auto elems = equilab_weighted_hands_to_weighted_elems(g.weighted_hands);
-    return range{g.info->name, std::move(elems), g.info->rgb};
+  std::transform(begin, end, std::back_inserter(subranges), [](auto g) {
+    auto elems = equilab_weighted_hands_to_weighted_elems(g->weighted_hands);
+    return range{g->info->name, std::move(elems), g->info->rgb};
   });
   for (auto it = begin; it != end; ++it)
   {
-    if (it->info->nesting_index > 0)
+    auto const& info = *(*it)->info;
+    if (info.nesting_index > 0)
     {
-      auto const parent_pos = index_to_pos[it->info->parent_index];
-      // copy, to be able to erase remove after
+      auto const parent_pos = index_to_pos[info.parent_index];
+      // children are nested before their parents, and only non nested
+      // ranges are kept
       subranges[parent_pos].add_subrange(
-          subranges[index_to_pos[it->info->index]]);
+          std::move(subranges[index_to_pos[info.index]]));
     }
   }
   auto const first_non_nested_pos = std::distance(begin, first_non_nested);
@@ -166,10 +188,10 @@ range::range(std::string name,
              std::vector<weighted_elems> elems,
              int rgb,
              std::vector<range> subranges)
-  : _name(std::move(name)),
+  : _name(name),
     _elems(std::move(elems)),
-    _rgb(rgb),
-    _subranges(std::move(subranges))
+    _subranges(std::move(subranges)),
+    _rgb(rgb)
 {
 }
 
@@ -178,11 +200,15 @@ range::range(equilab::parser::ast::range const& r) : _name(r.name), _rgb(0)
   if (r.groups.empty())
     throw std::runtime_error{"there must be at least one group in range"};
   auto& base_range = r.groups.front();
-  _elems = equilab_weighted_hands_to_weighted_elems(base_range.weighted_hands);
+  _elems = detail::cow{
+      equilab_weighted_hands_to_weighted_elems(base_range.weighted_hands)};
   if (r.groups.size() > 1)
   {
-    std::vector groups(r.groups.begin() + 1, r.groups.end());
-    _subranges = nest_equilab_ranges(groups.begin(), groups.end());
+    std::vector<equilab::parser::ast::group const*> groups;
+    for (auto it = r.groups.begin() + 1; it != r.groups.end(); ++it)
+      groups.push_back(&*it);
+    _subranges =
+        detail::cow{nest_equilab_ranges(groups.begin(), groups.end())};
   }
 }
 
@@ -190,66 +216,93 @@ range::range(pio::parser::ast::range const& r) : _rgb(0)
 {
   if (r.base_range.weights.size() != nb_total_combos)
     throw std::runtime_error{"base_range does not have 1326 weights"};
-  _elems = weights_to_weighted_elems(r.base_range.weights);
+  _elems = detail::cow{weights_to_weighted_elems(r.base_range.weights)};
   for (auto const& s : r.subranges)
   {
     if (s.weights.size() != nb_total_combos)
       throw std::runtime_error{"subrange does not have 1326 weights"};
     auto sub_elems = weights_to_weighted_elems(s.weights, r.base_range.weights);
     if (!sub_elems.empty())
-      add_subrange({s.name, std::move(sub_elems), s.rgb});
+      emplace_subrange(s.name, std::move(sub_elems), s.rgb);
   }
 }
 
 void range::add_subrange(range const& r)
 {
-  _subranges.push_back(r);
+  _hash.reset();
+  _subranges.mut().push_back(r);
 }
 
 void range::add_subrange(range&& r)
 {
-  _subranges.push_back(std::move(r));
+  _hash.reset();
+  _subranges.mut().push_back(std::move(r));
 }
 
 range* range::find_subrange(std::string const& name)
 {
-  auto it = std::find_if(_subranges.begin(), _subranges.end(), [&](auto& s) {
-    return s.name() == name;
-  });
-  if (it == _subranges.end())
-    return nullptr;
-  return std::addressof(*it);
+  auto const handle = interned_name::find(name);
+  return handle ? find_subrange(*handle) : nullptr;
 }
 
 range const* range::find_subrange(std::string const& name) const
 {
-  return const_cast<range const*>(
-      (*const_cast<range const*>(this)).find_subrange(name));
+  auto const handle = interned_name::find(name);
+  return handle ? find_subrange(*handle) : nullptr;
+}
+
+range* range::find_subrange(interned_name name)
+{
+  return find_by_name(subranges(), name);
+}
+
+range const* range::find_subrange(interned_name name) const
+{
+  return find_by_name(subranges(), name);
 }
 
 void range::set_rgb(int rgb)
 {
+  _hash.reset();
   _rgb = rgb;
 }
 
 void range::set_name(std::string name)
 {
-  _name = std::move(name);
+  _hash.reset();
+  _name = interned_name{name};
 }
 
 void range::set_elems(std::vector<weighted_elems> elems)
 {
-  _elems = std::move(elems);
+  _hash.reset();
+  _elems = detail::cow{std::move(elems)};
+}
+
+void range::share_elems_with(range const& other)
+{
+  // elems are equal, so is the hash
+  _elems = other._elems;
 }
 
 std::string const& range::name() const
+{
+  return _name.str();
+}
+
+interned_name range::name_handle() const
 {
   return _name;
 }
 
 auto range::elems() const -> std::vector<weighted_elems> const&
 {
-  return _elems;
+  return _elems.get();
+}
+
+bool range::shares_elems() const
+{
+  return _elems.shared();
 }
 
 int range::rgb() const
@@ -259,19 +312,41 @@ int range::rgb() const
 
 std::vector<range> const& range::subranges() const
 {
-  return _subranges;
+  return _subranges.get();
 }
 
 std::vector<range>& range::subranges()
 {
-  return _subranges;
+  _hash.reset();
+  return _subranges.mut();
+}
+
+std::size_t range::hash() const
+{
+  return _hash.get([this] {
+    std::size_t h = 0;
+    boost::hash_combine(h, _name.id());
+    boost::hash_combine(h, _rgb);
+    for (auto const& [weight, elems] : elems())
+    {
+      boost::hash_combine(h, weight);
+      for (auto const& e : elems)
+        boost::hash_combine(h, e.id());
+    }
+    for (auto const& sub : subranges())
+      boost::hash_combine(h, sub.hash());
+    return h;
+  });
 }
 
 bool operator==(range const& lhs, range const& rhs)
 {
-  return lhs.rgb() == rhs.rgb() &&
-         std::tie(lhs.name(), lhs.elems(), lhs.subranges()) ==
-             std::tie(rhs.name(), rhs.elems(), rhs.subranges());
+  if (lhs.rgb() != rhs.rgb() || lhs.name_handle() != rhs.name_handle())
+    return false;
+  // unmodified copies share their elems and subranges
+  return (&lhs.elems() == &rhs.elems() || lhs.elems() == rhs.elems()) &&
+         (&lhs.subranges() == &rhs.subranges() ||
+          lhs.subranges() == rhs.subranges());
 }
 
 bool operator!=(range const& lhs, range const& rhs)
@@ -2,45 +2,78 @@
 
 #include <prc/detail/unicode.hpp>
 
+#include <cstdint>
 #include <iostream>
 
 namespace prc
 {
-range_elem::range_elem(hand const& h) : _v(h)
+namespace
 {
+constexpr std::uint16_t hand_tag = 0x4000;
+constexpr std::uint16_t hand_range_tag = 0x8000;
+constexpr std::uint16_t nb_hands = 169;
 }
 
-range_elem::range_elem(combo const& c) : _v(c)
+range_elem::range_elem(hand const& h) : _bits(hand_tag | h.id())
 {
 }
 
-range_elem::range_elem(hand_range const& hr) : _v(hr)
+range_elem::range_elem(combo const& c) : _bits(c.id())
+{
+}
+
+range_elem::range_elem(hand_range const& hr)
+  : _bits(hand_range_tag | (hr.from().id() * nb_hands + hr.to().id()))
 {
 }
 
 range_elem::range_elem(parser::ast::range_elem const& re)
 {
   if (auto p = boost::get<parser::ast::hand>(&re))
-    _v = hand{*p};
+    *this = range_elem{hand{*p}};
   else if (auto p = boost::get<parser::ast::hand_range>(&re))
-    _v = hand_range{*p};
+    *this = range_elem{hand_range{*p}};
   else
-    _v = combo{boost::get<parser::ast::combo>(re)};
+    *this = range_elem{combo{boost::get<parser::ast::combo>(re)}};
+}
+
+combo range_elem::to_combo() const
+{
+  return combo::from_id(_bits);
+}
+
+hand range_elem::to_hand() const
+{
+  return hand::from_id(static_cast<std::uint8_t>(_bits & ~hand_tag));
+}
+
+hand_range range_elem::to_hand_range() const
+{
+  auto const i = _bits & ~hand_range_tag;
+  return hand_range{hand::from_id(static_cast<std::uint8_t>(i / nb_hands)),
+                    hand::from_id(static_cast<std::uint8_t>(i % nb_hands))};
 }
 
 std::string range_elem::string() const
 {
-  return boost::variant2::visit([](auto& e) { return e.string(); }, _v);
+  return visit([](auto const& e) { return e.string(); });
 }
 
 int range_elem::index() const
 {
-  return _v.index();
+  if (_bits & hand_range_tag)
+    return 2;
+  return (_bits & hand_tag) ? 1 : 0;
+}
+
+std::uint16_t range_elem::id() const
+{
+  return _bits;
 }
 
 bool operator==(range_elem const& lhs, range_elem const& rhs)
 {
-  return lhs._v == rhs._v;
+  return lhs._bits == rhs._bits;
 }
 
 bool operator!=(range_elem const& lhs, range_elem const& rhs)
@@ -50,7 +83,7 @@ bool operator!=(range_elem const& lhs, range_elem const& rhs)
 
 bool operator<(range_elem const& lhs, range_elem const& rhs)
 {
-  return lhs._v < rhs._v;
+  return lhs._bits < rhs._bits;
 }
 
 std::ostream& operator<<(std::ostream& os, range_elem const& h)
@@ -0,0 +1,81 @@
+#include <prc/range_index.hpp>
+
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+namespace prc
+{
+namespace
+{
+void recurse_fill_ranges(folder& root,
+                         fs::path const& current_path,
+                         std::vector<flattened_range>& out)
+{
+  for (auto& entry : root.entries())
+  {
+    if (auto p = boost::variant2::get_if<range>(&entry))
+      out.push_back({current_path / p->name(), &root, p});
+    else
+    {
+      auto& subfolder = boost::variant2::get<folder>(entry);
+      recurse_fill_ranges(subfolder, current_path / subfolder.name(), out);
+    }
+  }
+}
+}
+
+std::vector<flattened_range> flatten_ranges(folder& f,
+                                            fs::path const& current_path)
+{
+  std::vector<flattened_range> ret;
+  recurse_fill_ranges(f, current_path, ret);
+  return ret;
+}
+
+range_index::range_index(std::vector<flattened_range> ranges)
+  : _ranges(std::move(ranges))
+{
+  _positions.reserve(_ranges.size());
+  for (std::size_t i = 0; i < _ranges.size(); ++i)
+    _positions[_ranges[i].range->name_handle()].push_back(i);
+}
+
+std::vector<flattened_range> const& range_index::ranges() const
+{
+  return _ranges;
+}
+
+std::vector<std::size_t> const& range_index::find(std::string const& name) const
+{
+  static std::vector<std::size_t> const empty;
+  auto const handle = interned_name::find(name);
+  return handle ? find(*handle) : empty;
+}
+
+std::vector<std::size_t> const& range_index::find(interned_name name) const
+{
+  static std::vector<std::size_t> const empty;
+  auto const it = _positions.find(name);
+  return it == _positions.end() ? empty : it->second;
+}
+
+std::optional<std::size_t> range_index::find_before(std::string const& name,
+                                                    std::size_t pos) const
+{
+  auto const handle = interned_name::find(name);
+  if (!handle)
+    return std::nullopt;
+  return find_before(*handle, pos);
+}
+
+std::optional<std::size_t> range_index::find_before(interned_name name,
+                                                    std::size_t pos) const
+{
+  auto const& positions = find(name);
+  auto const it = std::lower_bound(positions.begin(), positions.end(), pos);
+  if (it == positions.begin())
+    return std::nullopt;
+  return *(it - 1);
+}
+}
@@ -1,6 +1,6 @@
 #include <prc/unpaired_hand.hpp>
 
-#include <sstream>
+#include <ostream>
 #include <stdexcept>
 
 namespace prc
@@ -41,9 +41,9 @@ bool unpaired_hand::offsuit() const
 
 std::string unpaired_hand::string() const
 {
-  std::stringstream ss;
-  ss << _high << _low << _suitedness;
-  return ss.str();
+  return {rank_str[static_cast<int>(_high)],
+          rank_str[static_cast<int>(_low)],
+          suitedness_str[static_cast<int>(_suitedness)]};
 }
 
 bool operator==(unpaired_hand const& lhs, unpaired_hand const& rhs) noexcept
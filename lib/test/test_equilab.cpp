@@ -19,6 +19,8 @@ using namespace prc::parser::ast::literals;
 
 namespace
 {
+using hands = equilab::parser::ast::hands;
+
 template <typename Parser>
 auto init_context(std::u32string const& input,
                   Parser p,
@@ -46,7 +48,7 @@ std::u32string read_all(fs::path const& p)
 using namespace std::string_literals;
 TEST_CASE("equilab format tests", "[equilab]")
 {
-  std::vector const any_two{
+  hands const any_two{
       "22+"_ast_re,  "A2o+"_ast_re, "K2o+"_ast_re, "Q2o+"_ast_re, "J2o+"_ast_re,
       "T2o+"_ast_re, "92o+"_ast_re, "82o+"_ast_re, "72o+"_ast_re, "62o+"_ast_re,
       "52o+"_ast_re, "42o+"_ast_re, "32o"_ast_re,  "A2s+"_ast_re, "K2s+"_ast_re,
@@ -136,14 +138,12 @@ TEST_CASE("equilab format tests", "[equilab]")
     REQUIRE_FALSE(group.info.has_value());
     REQUIRE(group.weighted_hands.size() == 3);
     CHECK(group.weighted_hands[0].weight == 100.0);
-    CHECK(group.weighted_hands[0].hands ==
-          std::vector{"AA"_ast_re, "AKs"_ast_re});
+    CHECK(group.weighted_hands[0].hands == hands{"AA"_ast_re, "AKs"_ast_re});
     CHECK(group.weighted_hands[1].weight == 99.0);
-    CHECK(group.weighted_hands[1].hands ==
-          std::vector{"AQs"_ast_re, "KJs"_ast_re});
+    CHECK(group.weighted_hands[1].hands == hands{"AQs"_ast_re, "KJs"_ast_re});
     CHECK(group.weighted_hands[2].weight == 96.0);
     CHECK(group.weighted_hands[2].hands ==
-          std::vector{"A8s"_ast_re, "Q8s"_ast_re, "T8s"_ast_re});
+          hands{"A8s"_ast_re, "Q8s"_ast_re, "T8s"_ast_re});
 
     prc::range const abstract_range{range};
     std::vector<prc::range::weighted_elems> const expected = {
@@ -222,9 +222,9 @@ TEST_CASE("equilab format tests", "[equilab]")
     CHECK(raise_group.info->rgb == 0xffe48073);
     CHECK(raise_group.weighted_hands[0].weight == 100.0);
     CHECK(raise_group.weighted_hands[0].hands ==
-          std::vector{"22+"_ast_re, "A2s+"_ast_re});
+          hands{"22+"_ast_re, "A2s+"_ast_re});
     CHECK(raise_group.weighted_hands[1].weight == 95.0);
-    CHECK(raise_group.weighted_hands[1].hands == std::vector{"A2o+"_ast_re});
+    CHECK(raise_group.weighted_hands[1].hands == hands{"A2o+"_ast_re});
 
     auto& call_group = range.groups[2];
     REQUIRE(call_group.info.has_value());
@@ -236,9 +236,9 @@ TEST_CASE("equilab format tests", "[equilab]")
     CHECK(call_group.info->name == "Call");
     CHECK(call_group.info->rgb == 0xff80ff00);
     CHECK(call_group.weighted_hands[0].weight == 100.0);
-    CHECK(call_group.weighted_hands[0].hands == std::vector{"K2s+"_ast_re});
+    CHECK(call_group.weighted_hands[0].hands == hands{"K2s+"_ast_re});
     CHECK(call_group.weighted_hands[1].weight == 95.0);
-    CHECK(call_group.weighted_hands[1].hands == std::vector{"K2o+"_ast_re});
+    CHECK(call_group.weighted_hands[1].hands == hands{"K2o+"_ast_re});
   }
 
   SECTION("unicode")
@@ -260,7 +260,7 @@ TEST_CASE("equilab format tests", "[equilab]")
     auto& group = range.groups.front();
     REQUIRE(group.weighted_hands.size() == 1);
     CHECK(group.weighted_hands.front().weight == 100.0);
-    CHECK(group.weighted_hands.front().hands == std::vector{"AA"_ast_re});
+    CHECK(group.weighted_hands.front().hands == hands{"AA"_ast_re});
   }
 
   SECTION("folders")
@@ -344,7 +344,7 @@ TEST_CASE("equilab format tests", "[equilab]")
     CHECK(raise_group.info->rgb == 0xffe48073);
     CHECK(raise_group.weighted_hands[0].weight == 100.0);
     CHECK(raise_group.weighted_hands[0].hands ==
-          std::vector{"AA"_ast_re, "AKs"_ast_re});
+          hands{"AA"_ast_re, "AKs"_ast_re});
 
     auto& call_group = range.groups[2];
     REQUIRE(call_group.info.has_value());
@@ -357,7 +357,7 @@ TEST_CASE("equilab format tests", "[equilab]")
     CHECK(call_group.info->rgb == 0xff80ff00);
     CHECK(call_group.weighted_hands[0].weight == 100.0);
     CHECK(call_group.weighted_hands[0].hands ==
-          std::vector{"AQs"_ast_re, "AKo"_ast_re});
+          hands{"AQs"_ast_re, "AKo"_ast_re});
 
     auto& call_vs_3bet_group = range.groups[3];
     REQUIRE(call_vs_3bet_group.info.has_value());
@@ -369,8 +369,7 @@ TEST_CASE("equilab format tests", "[equilab]")
     CHECK(call_vs_3bet_group.info->name == "Call vs 3bet");
     CHECK(call_vs_3bet_group.info->rgb == 0xff80ff00);
     CHECK(call_vs_3bet_group.weighted_hands[0].weight == 100.0);
-    CHECK(call_vs_3bet_group.weighted_hands[0].hands ==
-          std::vector{"AA"_ast_re});
+    CHECK(call_vs_3bet_group.weighted_hands[0].hands == hands{"AA"_ast_re});
 
     auto& fold_vs_3bet_group = range.groups[4];
     REQUIRE(fold_vs_3bet_group.info.has_value());
@@ -382,8 +381,7 @@ TEST_CASE("equilab format tests", "[equilab]")
     CHECK(fold_vs_3bet_group.info->name == "Fold vs 3bet");
     CHECK(fold_vs_3bet_group.info->rgb == 0xff0080ff);
     CHECK(fold_vs_3bet_group.weighted_hands[0].weight == 100.0);
-    CHECK(fold_vs_3bet_group.weighted_hands[0].hands ==
-          std::vector{"AKs"_ast_re});
+    CHECK(fold_vs_3bet_group.weighted_hands[0].hands == hands{"AKs"_ast_re});
   }
 
   SECTION("folders and ranges")
@@ -480,6 +478,8 @@ TEST_CASE("serialization tests", "[equilab]")
 
     prc::folder folder{"/", entries};
     auto const serialized = equilab::serialize(folder);
+    detail::thread_pool pool{3};
+    CHECK(equilab::serialize(folder, &pool) == serialized);
     auto const utf32 = detail::utf16le_to_utf32(serialized);
     b = utf32.begin();
     e = utf32.end();
@@ -4,7 +4,10 @@
 
 #include <catch2/catch.hpp>
 
+#include <prc/folder.hpp>
 #include <prc/gtoplus/parser/api.hpp>
+#include <prc/gtoplus/serialize.hpp>
+#include <prc/range.hpp>
 
 extern std::string testDataPath;
 
@@ -181,3 +184,65 @@ TEST_CASE("gtoplus format tests", "[gtoplus]")
     CHECK(b);
   }
 }
+
+TEST_CASE("gtoplus serialization tests", "[gtoplus]")
+{
+  using namespace prc::literals;
+
+  prc::range r{"\xf0\x9f\x82\xa1 grouped range", {{100.0, {"AA"_re, "KK"_re}}}};
+  r.add_subrange({"Raise", {{100.0, {"AA"_re}}}, 0xe9967a});
+  r.add_subrange({"Call", {{100.0, {"KK"_re}}}, 0x8fbc8b});
+  prc::folder category{"category"};
+  category.add_entry(r);
+  category.add_entry(prc::range{"weights", {{33.5, {"AKs"_re}}}});
+  prc::folder root{"/"};
+  root.add_entry(category);
+
+  auto const [newdefs3, settings] = gtoplus::serialize(root);
+  auto ctx = init_context(newdefs3, gtoplus::parser::file());
+  auto begin = newdefs3.begin();
+  auto const end = newdefs3.end();
+
+  std::vector<gtoplus::parser::ast::entry> entries;
+  auto const res = x3::phrase_parse(begin, end, ctx, x3::space, entries);
+  REQUIRE(res);
+  REQUIRE(begin == end);
+  REQUIRE(entries.size() == 4);
+
+  auto& root_category = boost::get<gtoplus::parser::ast::category>(entries[0]);
+  CHECK(root_category.info.name == "default_name");
+  CHECK(root_category.info.nb_subentries == 1);
+  auto& sub_category = boost::get<gtoplus::parser::ast::category>(entries[1]);
+  CHECK(sub_category.info.name == "category");
+  CHECK(sub_category.info.nb_subentries == 2);
+
+  auto& grouped = boost::get<gtoplus::parser::ast::range>(entries[2]);
+  CHECK(grouped.info.name == "\xf0\x9f\x82\xa1 grouped range");
+  REQUIRE(grouped.groups.size() == 2);
+  CHECK(grouped.groups[0].name == "Raise");
+  CHECK(grouped.groups[0].group_index == 0);
+  CHECK(grouped.groups[1].name == "Call");
+  CHECK(grouped.groups[1].group_index == 1);
+  REQUIRE(grouped.weighted_elems.size() == 1);
+  CHECK(grouped.weighted_elems.front().weight == 100.0);
+  REQUIRE(grouped.hand_info.size() == 169);
+  auto const& aces_ratios = grouped.hand_info.front().group_ratios;
+  REQUIRE(aces_ratios.size() == 1);
+  CHECK(aces_ratios.front().index == 0);
+  CHECK(aces_ratios.front().ratio == 1.0);
+
+  auto& weights = boost::get<gtoplus::parser::ast::range>(entries[3]);
+  CHECK(weights.info.name == "weights");
+  CHECK(weights.groups.empty());
+  REQUIRE(weights.weighted_elems.size() == 1);
+  CHECK(weights.weighted_elems.front().weight == 33.5);
+  CHECK(weights.weighted_elems.front().elems == std::vector{"AKs"_ast_re});
+
+  CHECK(settings.find("1) 233 150 122\n2) 143 188 139\n") !=
+        std::string::npos);
+
+  detail::thread_pool pool{3};
+  auto const parallel = gtoplus::serialize(root, &pool);
+  CHECK(parallel.newdefs3 == newdefs3);
+  CHECK(parallel.settings == settings);
+}
@@ -1,11 +1,16 @@
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <sstream>
 
 #include <catch2/catch.hpp>
 
 #include <prc/combo.hpp>
+#include <prc/detail/hash.hpp>
 #include <prc/detail/unicode.hpp>
+#include <prc/equilab/serialize.hpp>
+#include <prc/pio/manifest.hpp>
+#include <prc/pio/parse.hpp>
 #include <prc/pio/parser/api.hpp>
 #include <prc/range.hpp>
 #include <prc/range_elem.hpp>
@@ -53,6 +58,13 @@ std::vector<prc::combo> weights_to_combos(
   }
   return ret;
 }
+
+std::uint64_t write_file(fs::path const& path, std::string const& content)
+{
+  fs::create_directories(path.parent_path());
+  std::ofstream{path.string(), std::ios::binary} << content;
+  return detail::fnv1a(content);
+}
 }
 
 TEST_CASE("pio format tests", "[pio]")
@@ -90,6 +102,89 @@ TEST_CASE("pio format tests", "[pio]")
     auto const& sub_elems = raise_subrange.elems();
     REQUIRE(sub_elems.size() == 1);
     CHECK(sub_elems.front().weight == 100.0);
-    CHECK(sub_elems.front().elems == std::vector{"22+"_re});
+    CHECK(sub_elems.front().elems == prc::range_elems{"22+"_re});
+  }
+}
+
+TEST_CASE("pio to equilab streaming", "[pio]")
+{
+  auto const pio_path = fs::path{testDataPath} / "pio";
+  auto const expected = equilab::serialize(pio::parse_folder(pio_path));
+
+  std::stringstream ss;
+  equilab::stream_serializer serializer{ss};
+  std::vector<std::string> range_names;
+  pio::walk_folder(pio_path,
+                   {[&](auto const& name) { serializer.open_folder(name); },
+                    [&] { serializer.close_folder(); },
+                    [&](auto&& r) {
+                      range_names.push_back(r.name());
+                      serializer.add_range(r);
+                    }});
+
+  CHECK(range_names == std::vector<std::string>{"pairs", "suited_aces"});
+  auto const content = ss.str();
+  REQUIRE(content.size() % 2 == 0);
+  CHECK(std::u16string(reinterpret_cast<char16_t const*>(content.data()),
+                       content.size() / 2) == expected);
+}
+
+TEST_CASE("pio manifest tests", "[pio]")
+{
+  auto const dst = fs::temp_directory_path() / "prc_manifest_tests";
+  fs::remove_all(dst);
+  pio::manifest const old{{"a/x.txt", write_file(dst / "a/x.txt", "x")},
+                          {"a/y.txt", write_file(dst / "a/y.txt", "y")},
+                          {"b/c/z.txt", write_file(dst / "b/c/z.txt", "z")},
+                          {"top.txt", write_file(dst / "top.txt", "top")}};
+  pio::write_manifest(old, dst);
+
+  SECTION("read")
+  {
+    CHECK(pio::read_manifest(dst) == old);
+    CHECK(pio::read_manifest(dst / "a").empty());
   }
+
+  SECTION("unchanged files")
+  {
+    CHECK(pio::is_unchanged(old, "a/x.txt", detail::fnv1a("x"), dst));
+    CHECK_FALSE(pio::is_unchanged(old, "a/x.txt", detail::fnv1a("x2"), dst));
+    // not in the manifest, compared with the content on disk
+    CHECK(pio::is_unchanged({}, "a/y.txt", detail::fnv1a("y"), dst));
+    CHECK_FALSE(pio::is_unchanged({}, "a/y.txt", detail::fnv1a("y2"), dst));
+    fs::remove(dst / "a/x.txt");
+    CHECK_FALSE(pio::is_unchanged(old, "a/x.txt", detail::fnv1a("x"), dst));
+  }
+
+  SECTION("folder removed")
+  {
+    pio::manifest const current{{"b/c/z.txt", old.at("b/c/z.txt")},
+                                {"top.txt", old.at("top.txt")}};
+    auto const removed = pio::remove_stale_files(old, current, dst);
+    CHECK(removed == std::vector{dst / "a/x.txt", dst / "a/y.txt"});
+    CHECK_FALSE(fs::exists(dst / "a"));
+    CHECK(fs::exists(dst / "b/c/z.txt"));
+    CHECK(fs::exists(dst / "top.txt"));
+  }
+
+  SECTION("nested folder removed")
+  {
+    pio::manifest const current{{"top.txt", old.at("top.txt")}};
+    pio::remove_stale_files(old, current, dst);
+    CHECK_FALSE(fs::exists(dst / "a"));
+    CHECK_FALSE(fs::exists(dst / "b"));
+    CHECK(fs::exists(dst / "top.txt"));
+  }
+
+  SECTION("dst subtree deleted externally")
+  {
+    fs::remove_all(dst / "a");
+    fs::remove(dst / "b/c/z.txt");
+    pio::manifest const current{{"top.txt", old.at("top.txt")}};
+    CHECK(pio::remove_stale_files(old, current, dst).empty());
+    CHECK_FALSE(fs::exists(dst / "b"));
+    CHECK(fs::exists(dst / "top.txt"));
+  }
+
+  fs::remove_all(dst);
 }
@@ -1,6 +1,26 @@
 #include <catch2/catch.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+
+#include <prc/deduplicate.hpp>
+#include <prc/detail/arena.hpp>
+#include <prc/detail/format.hpp>
+#include <prc/detail/hash.hpp>
+#include <prc/detail/parallel.hpp>
+#include <prc/detail/profile.hpp>
+#include <prc/detail/thread_pool.hpp>
+#include <prc/interned_name.hpp>
+#include <prc/path_index.hpp>
+#include <prc/pio/serialize.hpp>
 #include <prc/range.hpp>
+#include <prc/range_index.hpp>
 #include <prc/range_elem.hpp>
 
 namespace
@@ -13,9 +33,16 @@ std::vector<T> sorted_vector(std::initializer_list<T> l)
   return ret;
 }
 
-std::vector<prc::range_elem> remove_elems(
-    std::vector<prc::range_elem> const& parent,
-    std::vector<prc::range_elem> const& to_remove)
+prc::range_elems sorted_elems(std::initializer_list<prc::range_elem> l)
+{
+  prc::range_elems ret(l.begin(), l.end());
+  std::sort(ret.begin(), ret.end());
+  return ret;
+}
+
+prc::range_elems remove_elems(
+    prc::range_elems const& parent,
+    prc::range_elems const& to_remove)
 {
   using namespace prc::literals;
   auto ret = parent;
@@ -97,7 +124,7 @@ TEST_CASE("expand/reduce tests", "[combos]")
     SECTION("multiple combinations")
     {
       auto const expanded = prc::expand_combos(
-          std::vector{"AKs"_re, "AKo"_re, "AhKs"_re, "AA"_re, "AA-KK"_re});
+          prc::range_elems{"AKs"_re, "AKo"_re, "AhKs"_re, "AA"_re, "AA-KK"_re});
       CHECK(expanded ==
             sorted_vector({"AhAd"_c, "AhAs"_c, "AhAc"_c, "AdAs"_c, "AdAc"_c,
                            "AcAs"_c, "KhKd"_c, "KhKs"_c, "KhKc"_c, "KdKs"_c,
@@ -114,12 +141,12 @@ TEST_CASE("expand/reduce tests", "[combos]")
     {
       auto reduced = prc::reduce_combos(std::vector{
           "AhAd"_c, "AhAs"_c, "AhAc"_c, "AdAs"_c, "AdAc"_c, "AcAs"_c});
-      CHECK(reduced == std::vector{"AA"_re});
+      CHECK(reduced == prc::range_elems{"AA"_re});
 
       reduced = prc::reduce_combos(
           std::vector{"AhAd"_c, "AhAs"_c, "AhAc"_c, "AdAs"_c, "AdAc"_c});
       CHECK(reduced ==
-            sorted_vector(
+            sorted_elems(
                 {"AhAd"_re, "AhAs"_re, "AhAc"_re, "AdAs"_re, "AdAc"_re}));
 
       reduced = prc::reduce_combos(std::vector{"AhAd"_c,
@@ -129,7 +156,7 @@ TEST_CASE("expand/reduce tests", "[combos]")
                                                "AdAc"_c,
                                                "AcAs"_c,
                                                "QhQs"_c});
-      CHECK(reduced == sorted_vector({"AA"_re, "QhQs"_re}));
+      CHECK(reduced == sorted_elems({"AA"_re, "QhQs"_re}));
 
       reduced = prc::reduce_combos(std::vector{"AhAd"_c,
                                                "AhAs"_c,
@@ -143,7 +170,7 @@ TEST_CASE("expand/reduce tests", "[combos]")
                                                "KdKs"_c,
                                                "KdKc"_c,
                                                "KcKs"_c});
-      CHECK(reduced == sorted_vector({"AA-KK"_re}));
+      CHECK(reduced == sorted_elems({"AA-KK"_re}));
 
       reduced = prc::reduce_combos(std::vector{"AhAd"_c,
                                                "AhAs"_c,
@@ -163,14 +190,14 @@ TEST_CASE("expand/reduce tests", "[combos]")
                                                "QdQs"_c,
                                                "QdQc"_c,
                                                "QcQs"_c});
-      CHECK(reduced == sorted_vector({"AA-QQ"_re}));
+      CHECK(reduced == sorted_elems({"AA-QQ"_re}));
 
       reduced = prc::reduce_combos(std::vector{
           "AhAd"_c, "AhAs"_c, "AhAc"_c, "AdAs"_c, "AdAc"_c, "AcAs"_c,
           "KhKd"_c, "KhKs"_c, "KhKc"_c, "KdKs"_c, "KdKc"_c, "KcKs"_c,
           "QhQd"_c, "QhQs"_c, "QhQc"_c, "QdQs"_c, "QdQc"_c, "QcQs"_c,
           "7h7d"_c, "7h7s"_c, "7h7c"_c, "7d7s"_c, "7d7c"_c, "7c7s"_c});
-      CHECK(reduced == sorted_vector({"AA-QQ"_re, "77"_re}));
+      CHECK(reduced == sorted_elems({"AA-QQ"_re, "77"_re}));
 
       reduced = prc::reduce_combos(std::vector{
           "AhAd"_c, "AhAs"_c, "AhAc"_c, "AdAs"_c, "AdAc"_c, "AcAs"_c, "KhKd"_c,
@@ -180,17 +207,17 @@ TEST_CASE("expand/reduce tests", "[combos]")
           "6d6c"_c, "6c6s"_c, "5h5d"_c, "5h5s"_c, "5h5c"_c, "5d5s"_c, "5d5c"_c,
           "5c5s"_c, "4h4d"_c, "4h4s"_c, "4h4c"_c, "4d4s"_c, "4d4c"_c, "4c4s"_c,
           "2h2d"_c, "2h2s"_c, "2h2c"_c, "2d2s"_c, "2d2c"_c, "2c2s"_c});
-      CHECK(reduced == sorted_vector({"AA-QQ"_re, "77-44"_re, "22"_re}));
+      CHECK(reduced == sorted_elems({"AA-QQ"_re, "77-44"_re, "22"_re}));
     }
 
     SECTION("suited unpaired hand")
     {
       auto reduced = prc::reduce_combos(
           std::vector{"AhKh"_c, "AsKs"_c, "AcKc"_c, "AdKd"_c});
-      CHECK(reduced == std::vector{"AKs"_re});
+      CHECK(reduced == prc::range_elems{"AKs"_re});
 
       reduced = prc::reduce_combos(std::vector{"AhKh"_c, "AsKs"_c, "AcKc"_c});
-      CHECK(reduced == sorted_vector({"AhKh"_re, "AsKs"_re, "AcKc"_re}));
+      CHECK(reduced == sorted_elems({"AhKh"_re, "AsKs"_re, "AcKc"_re}));
 
       reduced = prc::reduce_combos(std::vector{"AhKh"_c,
                                                "AsKs"_c,
@@ -204,7 +231,7 @@ TEST_CASE("expand/reduce tests", "[combos]")
                                                "AdJd"_c,
                                                "AsJs"_c,
                                                "AcJc"_c});
-      CHECK(reduced == std::vector{"AKs-AJs"_re});
+      CHECK(reduced == prc::range_elems{"AKs-AJs"_re});
 
       reduced = prc::reduce_combos(std::vector{
           "9h6h"_c, "9s6s"_c, "9c6c"_c, "9d6d"_c, "9h5h"_c, "9d5d"_c, "9s5s"_c,
@@ -212,7 +239,7 @@ TEST_CASE("expand/reduce tests", "[combos]")
           "Ts6s"_c, "Tc6c"_c, "Td6d"_c, "Th5h"_c, "Td5d"_c, "Ts5s"_c, "Tc5c"_c,
           "Th4h"_c, "Td4d"_c, "Ts4s"_c, "Tc4c"_c,
       });
-      CHECK(reduced == sorted_vector({"96s-94s"_re, "KhQh"_re, "T4s-T6s"_re}));
+      CHECK(reduced == sorted_elems({"96s-94s"_re, "KhQh"_re, "T4s-T6s"_re}));
 
       reduced = prc::reduce_combos(std::vector{"AhKh"_c,
                                                "AsKs"_c,
@@ -226,7 +253,7 @@ TEST_CASE("expand/reduce tests", "[combos]")
                                                "QdJd"_c,
                                                "QsJs"_c,
                                                "QcJc"_c});
-      CHECK(reduced == std::vector{"AKs-QJs"_re});
+      CHECK(reduced == prc::range_elems{"AKs-QJs"_re});
     }
 
     SECTION("offsuit unpaired hand")
@@ -243,10 +270,10 @@ TEST_CASE("expand/reduce tests", "[combos]")
                                                     "AcKh"_c,
                                                     "AcKd"_c,
                                                     "AcKs"_c});
-      CHECK(reduced == std::vector{"AKo"_re});
+      CHECK(reduced == prc::range_elems{"AKo"_re});
 
       reduced = prc::reduce_combos(std::vector{"AhKs"_c, "AsKh"_c, "AcKh"_c});
-      CHECK(reduced == sorted_vector({"AhKs"_re, "AsKh"_re, "AcKh"_re}));
+      CHECK(reduced == sorted_elems({"AhKs"_re, "AsKh"_re, "AcKh"_re}));
 
       reduced = prc::reduce_combos(std::vector{
           "AhKs"_c, "AhKc"_c, "AhKd"_c, "AdKc"_c, "AdKh"_c, "AdKs"_c,
@@ -255,7 +282,7 @@ TEST_CASE("expand/reduce tests", "[combos]")
           "AsQh"_c, "AsQd"_c, "AsQc"_c, "AcQh"_c, "AcQd"_c, "AcQs"_c,
           "AhJs"_c, "AhJc"_c, "AhJd"_c, "AdJc"_c, "AdJh"_c, "AdJs"_c,
           "AsJh"_c, "AsJd"_c, "AsJc"_c, "AcJh"_c, "AcJd"_c, "AcJs"_c});
-      CHECK(reduced == std::vector{"AKo-AJo"_re});
+      CHECK(reduced == prc::range_elems{"AKo-AJo"_re});
 
       reduced = prc::reduce_combos(std::vector{
           "9h6s"_c, "9h6c"_c, "9h6d"_c, "9d6c"_c, "9d6h"_c, "9d6s"_c, "9s6h"_c,
@@ -277,7 +304,7 @@ TEST_CASE("expand/reduce tests", "[combos]")
           "Ts4d"_c, "Ts4c"_c, "Tc4h"_c, "Tc4d"_c, "Tc4s"_c,
       });
 
-      CHECK(reduced == sorted_vector({"96o-94o"_re, "KhQs"_re, "T4o-T6o"_re}));
+      CHECK(reduced == sorted_elems({"96o-94o"_re, "KhQs"_re, "T4o-T6o"_re}));
 
       reduced = prc::reduce_combos(std::vector{
           "AhKs"_c, "AhKc"_c, "AhKd"_c, "AdKc"_c, "AdKh"_c, "AdKs"_c,
@@ -288,7 +315,7 @@ TEST_CASE("expand/reduce tests", "[combos]")
 
           "QhJs"_c, "QhJc"_c, "QhJd"_c, "QdJc"_c, "QdJh"_c, "QdJs"_c,
           "QsJh"_c, "QsJd"_c, "QsJc"_c, "QcJh"_c, "QcJd"_c, "QcJs"_c});
-      CHECK(reduced == std::vector{"AKo-QJo"_re});
+      CHECK(reduced == prc::range_elems{"AKo-QJo"_re});
     }
 
     SECTION("combining everything")
@@ -343,7 +370,7 @@ TEST_CASE("expand/reduce tests", "[combos]")
           "5c5s"_c, "4h4d"_c, "4h4s"_c, "4h4c"_c, "4d4s"_c, "4d4c"_c, "4c4s"_c,
           "2h2d"_c, "2h2s"_c, "2h2c"_c, "2d2s"_c, "2d2c"_c, "2c2s"_c});
 
-      CHECK(reduced == sorted_vector({"AA-QQ"_re,
+      CHECK(reduced == sorted_elems({"AA-QQ"_re,
                                       "77-44"_re,
                                       "22"_re,
                                       "AKo-AJo"_re,
@@ -357,6 +384,126 @@ TEST_CASE("expand/reduce tests", "[combos]")
   }
 }
 
+TEST_CASE("range elem tests", "[combos]")
+{
+  using namespace prc::literals;
+
+  CHECK(sizeof(prc::range_elem) == 2);
+
+  SECTION("round trip")
+  {
+    for (auto const& c : prc::any_two_combos())
+      CHECK(prc::range_elem{c}.get<prc::combo>() == c);
+    CHECK("AKs"_re.string() == "AKs");
+    CHECK("T9o"_re.get<prc::hand>().string() == "T9o");
+    CHECK("AA-QQ"_re.get<prc::hand_range>().from().string() == "QQ");
+    CHECK("K2o-K9o"_re.string() == "K2o-K9o");
+    CHECK_FALSE("AhKh"_re.get_if<prc::hand>());
+  }
+
+  SECTION("ordering")
+  {
+    std::vector const elems{"AhKh"_re,
+                            "2c2d"_re,
+                            "AA"_re,
+                            "22"_re,
+                            "AKs"_re,
+                            "AKo"_re,
+                            "32o"_re,
+                            "QQ-22"_re,
+                            "AA-KK"_re,
+                            "A2s-A5s"_re,
+                            "K2o-K9o"_re};
+    for (auto const& lhs : elems)
+    {
+      for (auto const& rhs : elems)
+      {
+        auto const unpacked = lhs.visit([&](auto const& l) {
+          return rhs.visit([&](auto const& r) {
+            using L = std::decay_t<decltype(l)>;
+            using R = std::decay_t<decltype(r)>;
+            if constexpr (std::is_same_v<L, R>)
+              return l < r;
+            else
+              return lhs.index() < rhs.index();
+          });
+        });
+        CHECK((lhs < rhs) == unpacked);
+      }
+    }
+  }
+}
+
+TEST_CASE("packed ids tests", "[combos]")
+{
+  using namespace prc::literals;
+
+  CHECK(sizeof(prc::card) == 1);
+  CHECK(sizeof(prc::combo) == 2);
+  CHECK(sizeof(prc::hand) == 1);
+
+  auto const& all = prc::any_two_combos();
+  for (std::size_t i = 0; i < all.size(); ++i)
+  {
+    auto const c = prc::combo::from_id(static_cast<std::uint16_t>(i));
+    CHECK(c == all[i]);
+    CHECK(prc::combo{c.low(), c.high()} == c);
+    CHECK(prc::combo::from_ordered(c.high(), c.low()) == c);
+    CHECK(prc::card::from_id(c.high().id()) == c.high());
+  }
+
+  auto const hands = prc::expand_hands(prc::any_two());
+  REQUIRE(hands.size() == 169);
+  for (std::size_t i = 0; i < hands.size(); ++i)
+  {
+    CHECK(hands[i].id() == i);
+    CHECK(prc::hand::from_id(hands[i].id()) == hands[i]);
+  }
+  CHECK("AKs"_re.get<prc::hand>().get<prc::unpaired_hand>().suited());
+  CHECK("QQ"_re.get<prc::hand>().get<prc::paired_hand>().rank() ==
+        prc::rank::queen);
+}
+
+TEST_CASE("combo set tests", "[combos]")
+{
+  using namespace prc::literals;
+
+  SECTION("indexes follow any_two_combos")
+  {
+    auto const& all = prc::any_two_combos();
+    for (std::size_t i = 0; i < all.size(); ++i)
+      CHECK(prc::combo_index(all[i]) == i);
+  }
+
+  SECTION("insert")
+  {
+    prc::combo_set s{prc::range_elems{"AA"_re, "AhKh"_re}};
+    CHECK(s.size() == 7);
+    CHECK(s.contains("AcAs"_c));
+    CHECK(s.contains("AhKh"_c));
+    CHECK_FALSE(s.contains("AsKs"_c));
+    CHECK(prc::combo_set{}.empty());
+  }
+
+  SECTION("union and reduce")
+  {
+    prc::range_elems const lhs{"AA-QQ"_re, "AKs-AJs"_re, "96o-94o"_re};
+    prc::range_elems const rhs{"KK-JJ"_re, "AJs-ATs"_re, "7h6h"_re, "22"_re};
+    prc::combo_set s{lhs};
+    s |= prc::combo_set{rhs};
+
+    auto combos = prc::expand_combos(lhs);
+    auto const rhs_combos = prc::expand_combos(rhs);
+    combos.insert(combos.end(), rhs_combos.begin(), rhs_combos.end());
+    CHECK(prc::reduce_combos(s) == prc::reduce_combos(combos));
+    CHECK(prc::reduce_combos(s) == sorted_elems({"AA-JJ"_re,
+                                                  "22"_re,
+                                                  "AKs-ATs"_re,
+                                                  "96o-94o"_re,
+                                                  "7h6h"_re}));
+  }
+}
+
 TEST_CASE("range tests", "[range]")
 {
   using namespace prc::literals;
@@ -437,4 +584,455 @@ TEST_CASE("range tests", "[range]")
       CHECK(unassigned.empty());
     }
   }
+  SECTION("copies share their content until modified")
+  {
+    prc::range r{"UTG", {{100.0, {"22+"_re}}}};
+    r.add_subrange(prc::range{"Call", {{100.0, {"22-JJ"_re}}}});
+    auto const copy = r;
+    CHECK(&copy.elems() == &r.elems());
+    // the non-const accessors would clone
+    CHECK(&copy.subranges() == &std::as_const(r).subranges());
+
+    auto modified = copy;
+    modified.subranges().front().set_rgb(0xff);
+    modified.add_subrange(prc::range{"Fold", {}});
+    CHECK(&modified.elems() == &r.elems());
+    CHECK(copy == r);
+    CHECK(r.subranges().size() == 1);
+    CHECK(r.subranges().front().rgb() == 0);
+
+    prc::folder f{"/"};
+    f.add_entry(r);
+    auto g = f;
+    CHECK(&std::as_const(g).entries() == &std::as_const(f).entries());
+    g.remove_entry("UTG");
+    CHECK(g.entries().empty());
+    CHECK(f.entries().size() == 1);
+  }
+}
+
+TEST_CASE("range index tests", "[range]")
+{
+  using namespace prc::literals;
+
+  prc::folder root{"/"};
+  prc::folder sub{"sub"};
+  sub.add_entry(prc::range{"a", {{100.0, {"AA"_re}}}});
+  sub.add_entry(prc::range{"b", {{100.0, {"KK"_re}}}});
+  root.add_entry(prc::range{"a", {{100.0, {"QQ"_re}}}});
+  root.add_entry(sub);
+  root.add_entry(prc::range{"a", {{100.0, {"JJ"_re}}}});
+
+  prc::range_index const index{prc::flatten_ranges(root, "/")};
+  auto const& ranges = index.ranges();
+  REQUIRE(ranges.size() == 4);
+  CHECK(ranges[0].fullpath == "/a");
+  CHECK(ranges[1].fullpath == "/sub/a");
+  CHECK(ranges[2].fullpath == "/sub/b");
+  CHECK(ranges[3].fullpath == "/a");
+  CHECK(ranges[1].parent_folder->name() == "sub");
+
+  CHECK(index.find("a") == std::vector<std::size_t>{0, 1, 3});
+  CHECK(index.find("c").empty());
+  CHECK(index.find_before("a", 3) == 1);
+  CHECK(index.find_before("a", 1) == 0);
+  CHECK_FALSE(index.find_before("a", 0));
+  CHECK_FALSE(index.find_before("b", 2));
+}
+
+TEST_CASE("interned name tests", "[range]")
+{
+  prc::interned_name const call{"Call"};
+  CHECK(call.str() == "Call");
+  CHECK(prc::interned_name{std::string{"Ca"} + "ll"} == call);
+  CHECK(prc::interned_name{"Fold"} != call);
+  CHECK(prc::interned_name{}.str().empty());
+  CHECK(prc::interned_name{""} == prc::interned_name{});
+  CHECK(prc::interned_name::find("Call") == call);
+  CHECK_FALSE(prc::interned_name::find("never interned name"));
+  CHECK(std::hash<prc::interned_name>{}(call) == call.id());
+
+  prc::range r{"UTG", {}};
+  r.add_subrange(prc::range{"Call", {}});
+  CHECK(r.name_handle() == prc::interned_name{"UTG"});
+  CHECK(r.find_subrange(call) == &r.subranges().front());
+  CHECK(r.find_subrange("Call") == &r.subranges().front());
+  CHECK_FALSE(r.find_subrange("Fold"));
+  r.set_name("HJ");
+  CHECK(r.name() == "HJ");
+}
+
+TEST_CASE("path index tests", "[range]")
+{
+  using namespace prc::literals;
+
+  prc::range utg{"UTG", {{100.0, {"22+"_re}}}};
+  utg.add_subrange(prc::range{"Raise", {{100.0, {"QQ+"_re}}}});
+  utg.add_subrange(prc::range{"Call", {{100.0, {"22-JJ"_re}}}});
+  prc::folder sub{"SB"};
+  sub.add_entry(prc::range{"SB_a", {{100.0, {"AA"_re}}}});
+  sub.add_entry(utg);
+  sub.add_entry(prc::range{"SB_b", {{100.0, {"KK"_re}}}});
+  prc::folder root{"/"};
+  root.add_entry(sub);
+  root.add_entry(prc::range{"SB_a", {{100.0, {"QQ"_re}}}});
+
+  prc::path_index index{root};
+  REQUIRE(index.find("/SB"));
+  CHECK(index.find("/SB").f->name() == "SB");
+  CHECK(index.find("/").f == &root);
+  CHECK(index.find("SB/UTG/Call").r->name() == "Call");
+  CHECK(index.find("/SB_a").r->elems().front().elems ==
+        prc::range_elems{"QQ"_re});
+  CHECK_FALSE(index.find("/SB/UTG/Fold"));
+  CHECK_FALSE(index.find("/never interned component"));
+
+  CHECK(index.list("/SB/SB_") ==
+        std::vector<std::string>{"/SB/SB_a", "/SB/SB_b"});
+  CHECK(index.list("/SB/UTG/") ==
+        std::vector<std::string>{"/SB/UTG/Raise", "/SB/UTG/Call"});
+  CHECK(index.list("/S").size() == 7);
+  CHECK(index.list("/BB/").empty());
+
+  CHECK(index.remove("/SB/SB_a"));
+  CHECK_FALSE(index.remove("/SB/SB_a"));
+  CHECK_FALSE(index.remove("/"));
+  auto const& entries = index.find("/SB").f->entries();
+  REQUIRE(entries.size() == 2);
+  // later entries moved, the index follows them
+  CHECK(index.find("/SB/UTG").r == &boost::variant2::get<prc::range>(
+                                        entries[0]));
+  CHECK(index.find("/SB/SB_b").r->name() == "SB_b");
+  CHECK(index.remove("/SB/UTG/Raise"));
+  CHECK(index.find("/SB/UTG/Call").r ==
+        &index.find("/SB/UTG").r->subranges().front());
+  CHECK(index.list("/SB/") ==
+        std::vector<std::string>{"/SB/UTG", "/SB/UTG/Call", "/SB/SB_b"});
+
+  SECTION("copies are only detached along the removed path")
+  {
+    auto copy = root;
+    prc::path_index copy_index{copy};
+    REQUIRE(copy_index.find("/SB/UTG/Call"));
+    CHECK(&std::as_const(copy).entries() == &std::as_const(root).entries());
+
+    auto const utg_subranges = &copy_index.find("/SB/UTG").r->subranges();
+    CHECK(copy_index.remove("/SB/SB_b"));
+    CHECK(&std::as_const(copy).entries() != &std::as_const(root).entries());
+    CHECK(&copy_index.find("/SB/UTG").r->subranges() == utg_subranges);
+    CHECK(index.find("/SB/SB_b"));
+  }
+
+  SECTION("duplicate names")
+  {
+    prc::folder f{"/"};
+    f.add_entry(prc::range{"a", {{100.0, {"AA"_re}}}});
+    f.add_entry(prc::range{"a", {{100.0, {"KK"_re}}}});
+    prc::path_index index{f};
+    CHECK(index.find("/a").r == &boost::variant2::get<prc::range>(
+                                    f.entries()[0]));
+    CHECK(index.remove("/a"));
+    CHECK(index.find("/a").r->elems().front().elems ==
+          prc::range_elems{"KK"_re});
+  }
+}
+
+TEST_CASE("deduplicate tests", "[range]")
+{
+  using namespace prc::literals;
+
+  prc::range utg{"UTG", {{100.0, {"22+"_re}}}};
+  utg.add_subrange(prc::range{"Call", {{50.0, {"22-JJ"_re}}}});
+  prc::range hj{"HJ", {{100.0, {"22+"_re}}}};
+  hj.add_subrange(prc::range{"Call", {{50.0, {"22-JJ"_re}}}});
+  hj.add_subrange(prc::range{"Raise", {{50.0, {"22+"_re}}}});
+  prc::folder root{"/"};
+  root.add_entry(utg);
+  root.add_entry(hj);
+
+  CHECK(prc::deduplicate_elems(root) == 2);
+  CHECK(prc::deduplicate_elems(root) == 0);
+  auto const& entries = std::as_const(root).entries();
+  auto const& new_utg = boost::variant2::get<prc::range>(entries[0]);
+  auto const& new_hj = boost::variant2::get<prc::range>(entries[1]);
+  CHECK(&new_utg.elems() == &new_hj.elems());
+  CHECK(&new_utg.subranges()[0].elems() == &new_hj.subranges()[0].elems());
+  CHECK(new_hj.shares_elems());
+  CHECK(&new_hj.subranges()[1].elems() != &new_utg.elems());
+  CHECK(new_utg == utg);
+  CHECK(new_hj == hj);
+
+  prc::detail::render_cache cache;
+  CHECK(prc::pio::serialize(new_utg, cache) == prc::pio::serialize(utg));
+  CHECK(prc::pio::serialize(new_hj, cache) == prc::pio::serialize(hj));
+}
+
+TEST_CASE("model hash tests", "[range]")
+{
+  using namespace prc::literals;
+
+  std::unordered_set<prc::combo> combos{"AhKh"_c, "AhKh"_c, "AsKs"_c};
+  CHECK(combos.size() == 2);
+  std::unordered_set<prc::range_elem> elems{"AKs"_re, "AKs"_re, "AKo"_re};
+  CHECK(elems.size() == 2);
+
+  prc::range utg{"UTG", {{100.0, {"22+"_re}}}};
+  utg.add_subrange(prc::range{"Call", {{50.0, {"22-JJ"_re}}}});
+  prc::range const other{"UTG",
+                         {{100.0, {"22+"_re}}},
+                         0,
+                         {prc::range{"Call", {{50.0, {"22-JJ"_re}}}}}};
+  CHECK(utg.hash() == other.hash());
+  CHECK(utg == other);
+
+  auto copy = utg;
+  CHECK(copy.hash() == utg.hash());
+  copy.subranges().front().set_rgb(42);
+  CHECK(copy.hash() != utg.hash());
+  CHECK(copy != utg);
+  copy.subranges().front().set_rgb(0);
+  CHECK(copy.hash() == utg.hash());
+  CHECK(copy == utg);
+
+  prc::folder root{"/"};
+  root.add_entry(utg);
+  auto const root_hash = root.hash();
+  auto root_copy = root;
+  CHECK(std::hash<prc::folder>{}(root_copy) == root_hash);
+  root_copy.add_entry(prc::folder{"SB"});
+  CHECK(root_copy.hash() != root_hash);
+  root_copy.remove_entry("SB");
+  CHECK(root_copy.hash() == root_hash);
+  CHECK(root_copy == root);
+
+  SECTION("comparing does not cache hashes")
+  {
+    prc::range a{"A", {}, 1};
+    a.add_subrange({"x", {}, 2});
+    auto b = a;
+    auto* c = &a.subranges().front();
+    CHECK(a == b);
+    c->set_rgb(3);
+    b.subranges().front().set_rgb(3);
+    CHECK(a == b);
+  }
+}
+
+TEST_CASE("move and emplace tests", "[range]")
+{
+  using namespace prc::literals;
+
+  prc::folder root{"/"};
+  auto& sb = root.emplace_entry<prc::folder>("SB");
+  auto& call = sb.emplace_entry<prc::range>(
+      "Call", std::vector<prc::range::weighted_elems>{{100.0, {"22+"_re}}});
+  call.emplace_subrange(
+      "3bet", std::vector<prc::range::weighted_elems>{{50.0, {"AA"_re}}});
+  auto const& entries = std::as_const(root).entries();
+  REQUIRE(entries.size() == 1);
+  auto const& sb_entries =
+      std::as_const(boost::variant2::get<prc::folder>(entries[0])).entries();
+  REQUIRE(sb_entries.size() == 1);
+  auto const& stored = boost::variant2::get<prc::range>(sb_entries[0]);
+  CHECK(stored.name() == "Call");
+  REQUIRE(stored.subranges().size() == 1);
+  CHECK(stored.subranges()[0].name() == "3bet");
+
+  prc::range r{"BB", {{100.0, {"AKs"_re}}}};
+  auto const hash = r.hash();
+  auto const* elems = &r.elems();
+  prc::folder dst{"dst"};
+  dst.add_entry(std::move(r));
+  auto const& moved =
+      boost::variant2::get<prc::range>(std::as_const(dst).entries()[0]);
+  CHECK(&moved.elems() == elems);
+  CHECK(moved.hash() == hash);
+  // moved-from ranges recompute their hash
+  CHECK(r.hash() == prc::range{"BB", {}}.hash());
+}
+
+TEST_CASE("arena tests", "[arena]")
+{
+  using prc::detail::arena_vector;
+  using prc::detail::current_arena;
+  using prc::detail::scoped_arena;
+
+  auto const heap = std::pmr::get_default_resource();
+  CHECK(current_arena() == heap);
+  {
+    scoped_arena const outer;
+    auto const outer_resource = current_arena();
+    CHECK(outer_resource != heap);
+
+    arena_vector<int> v(100, 1);
+    CHECK(v.get_allocator().resource() == outer_resource);
+    {
+      scoped_arena const inner;
+      CHECK(current_arena() != outer_resource);
+      // copies allocate from the current arena, moves keep their resource
+      arena_vector<int> copy{v};
+      CHECK(copy.get_allocator().resource() == current_arena());
+      CHECK(copy == v);
+    }
+    CHECK(current_arena() == outer_resource);
+    auto moved = std::move(v);
+    CHECK(moved.get_allocator().resource() == outer_resource);
+  }
+  CHECK(current_arena() == heap);
+}
+
+TEST_CASE("format tests", "[format]")
+{
+  using prc::detail::format_double;
+
+  SECTION("fixed, trimmed")
+  {
+    CHECK(format_double(100.0, prc::detail::equilab_weight_format) == "100");
+    CHECK(format_double(59.5, prc::detail::equilab_weight_format) == "59.5");
+    CHECK(format_double(33.3333333, prc::detail::equilab_weight_format) ==
+          "33.333333");
+    CHECK(format_double(1.0, prc::detail::pio_weight_format) == "1");
+    CHECK(format_double(0.0, prc::detail::pio_weight_format) == "0");
+    CHECK(format_double(0.0004, prc::detail::pio_weight_format) == "0");
+    CHECK(format_double(0.595, prc::detail::pio_weight_format) == "0.595");
+    CHECK(format_double(0.25, prc::detail::pio_weight_format) == "0.25");
+  }
+
+  SECTION("minimum decimals")
+  {
+    prc::detail::float_format const fmt{std::chars_format::fixed, 2, 1};
+
+    CHECK(format_double(3.0, fmt) == "3.0");
+    CHECK(format_double(2.5, fmt) == "2.5");
+    CHECK(format_double(14.375, fmt) == "14.38");
+  }
+
+  SECTION("general")
+  {
+    CHECK(format_double(100.0, prc::detail::gtoplus_weight_format) == "100");
+    CHECK(format_double(33.3333333, prc::detail::gtoplus_weight_format) ==
+          "33.3333");
+  }
+}
+
+TEST_CASE("hash tests", "[hash]")
+{
+  using prc::detail::fnv1a;
+
+  CHECK(fnv1a("") == 0xcbf29ce484222325);
+  CHECK(fnv1a("a") == 0xaf63dc4c8601ec8c);
+  CHECK(fnv1a("bar", fnv1a("foo")) == fnv1a("foobar"));
+
+  std::uint64_t n;
+  CHECK(prc::detail::to_hex(0xaf63dc4c8601ec8c) == "af63dc4c8601ec8c");
+  CHECK(prc::detail::to_hex(1) == "0000000000000001");
+  REQUIRE(prc::detail::from_hex("af63dc4c8601ec8c", n));
+  CHECK(n == 0xaf63dc4c8601ec8c);
+  CHECK_FALSE(prc::detail::from_hex("xyz", n));
+}
+
+TEST_CASE("profile tests", "[profile]")
+{
+  using namespace prc::detail;
+
+  static profile_counter counter{"test counter"};
+  static profile_timer timer{"test timer"};
+
+  counter.add();
+  {
+    scoped_timer const t{timer};
+  }
+  CHECK(counter.value() == 0);
+  CHECK(timer.count() == 0);
+
+  set_profile_mode(profile_mode::trace);
+  counter.add(2);
+  {
+    scoped_timer const t{timer};
+  }
+  set_profile_mode(profile_mode::disabled);
+  CHECK(counter.value() == 2);
+  CHECK(timer.count() == 1);
+
+  std::ostringstream profile;
+  write_profile(profile);
+  CHECK_THAT(profile.str(), Catch::Contains("\"test counter\": 2"));
+  CHECK_THAT(profile.str(),
+             Catch::Contains("\"test timer\": {\"count\": 1"));
+  std::ostringstream trace;
+  write_trace(trace);
+  CHECK_THAT(trace.str(), Catch::Contains("{\"name\": \"test timer\""));
+}
+
+TEST_CASE("thread pool tests", "[thread_pool]")
+{
+  for (auto const nb_workers : {0, 1, 4})
+  {
+    prc::detail::thread_pool pool(nb_workers);
+
+    SECTION("tasks")
+    {
+      std::atomic<int> count{0};
+      prc::detail::task_group group;
+      for (auto i = 0; i < 1000; ++i)
+        pool.submit(group, [&] { ++count; });
+      pool.wait(group);
+      CHECK(count == 1000);
+    }
+
+    SECTION("subtasks")
+    {
+      std::atomic<int> count{0};
+      prc::detail::task_group group;
+      for (auto i = 0; i < 10; ++i)
+      {
+        pool.submit(group, [&] {
+          prc::detail::task_group subgroup;
+          for (auto j = 0; j < 10; ++j)
+            pool.submit(subgroup, [&] { ++count; });
+          pool.wait(subgroup);
+        });
+      }
+      pool.wait(group);
+      CHECK(count == 100);
+    }
+
+    SECTION("exceptions")
+    {
+      prc::detail::task_group group;
+      pool.submit(group, [] { throw std::runtime_error("error"); });
+      pool.submit(group, [] {});
+      CHECK_THROWS_AS(pool.wait(group), std::runtime_error);
+    }
+
+    SECTION("waiting for tasks running on other threads")
+    {
+      std::atomic<bool> done{false};
+      prc::detail::task_group group;
+      pool.submit(group, [&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds{20});
+        done = true;
+      });
+      pool.wait(group);
+      CHECK(done);
+    }
+
+    SECTION("parallel_for")
+    {
+      std::vector<int> values(100);
+      prc::detail::parallel_for(pool, values.size(), [&](std::size_t i) {
+        values[i] = static_cast<int>(i);
+      });
+      for (std::size_t i = 0; i < values.size(); ++i)
+        CHECK(values[i] == static_cast<int>(i));
+      CHECK_THROWS_AS(prc::detail::parallel_for(
+                          pool,
+                          10,
+                          [](std::size_t i) {
+                            if (i == 5)
+                              throw std::runtime_error("error");
+                          }),
+                      std::runtime_error);
+    }
+  }
 }